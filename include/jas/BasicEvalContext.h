@@ -16,11 +16,13 @@ class BasicEvalContext : public EvalContextIF {
  public:
   std::vector<String> supportedFunctions() const override;
   bool functionSupported(const StringView &functionName) const override;
+  bool functionIsPure(const StringView &functionName) const override;
   Var invoke(const String &name, const Var &param) override;
   Var *lookupVariable(const String &name) override;
   Var *putVariable(const String &name, Var val) override;
   EvalContextPtr subContext(const String &ctxtID,
                             ContextArguments input) override;
+  bool rebind(const String &ctxtID, ContextArguments input) override;
   Var arg(uint8_t pos) const noexcept override;
   void args(ContextArguments args) override;
   const ContextArguments &args() const noexcept override;
@@ -30,6 +32,10 @@ class BasicEvalContext : public EvalContextIF {
   BasicEvalContext *rootContext();
 
  protected:
+  /// Retargets the context as `rebind` does, for subclasses that can be
+  /// rebound
+  void retarget(const String &ctxtID, ContextArguments input);
+
   BasicEvalContext *parent_ = nullptr;
   String id_;
   VariableMap variables_;
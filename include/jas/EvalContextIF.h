@@ -17,11 +17,21 @@ class EvalContextIF {
   virtual ~EvalContextIF() = default;
   virtual std::vector<String> supportedFunctions() const = 0;
   virtual bool functionSupported(const StringView& functionName) const = 0;
+  /// pure function returns the same value for the same param during one
+  /// evaluation, regardless of which sub context invokes it
+  virtual bool functionIsPure(const StringView& /*functionName*/) const {
+    return false;
+  }
   virtual Var invoke(const String& name, const Var& param) = 0;
   virtual Var* lookupVariable(const String& name) = 0;
   virtual Var* putVariable(const String& name, Var val) = 0;
   virtual EvalContextPtr subContext(const String& ctxtID,
                                     ContextArguments input) = 0;
+  /// retargets this context to another input as if it was newly created by
+  /// `subContext` of its parent, returns false if it cannot be reused
+  virtual bool rebind(const String& /*ctxtID*/, ContextArguments /*input*/) {
+    return false;
+  }
   virtual Var arg(uint8_t pos) const noexcept = 0;
   virtual void args(ContextArguments) = 0;
   virtual const ContextArguments& args() const noexcept = 0;
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <memory>
+#include <memory_resource>
 
 #include "Json.h"
 #include "String.h"
@@ -9,6 +10,69 @@ namespace jas {
 
 class Macro;
 class Evaluable;
+
+/// Resource of objects owned by evaluable trees being translated on this
+/// thread, null for the heap
+inline std::shared_ptr<std::pmr::memory_resource>& treeMemoryResource() {
+  thread_local std::shared_ptr<std::pmr::memory_resource> resource;
+  return resource;
+}
+
+/// Allocator of objects owned by an evaluable tree, each of them shares
+/// ownership of the resource it is allocated from
+template <class T>
+class TreeAllocator {
+ public:
+  using value_type = T;
+
+  explicit TreeAllocator(std::shared_ptr<std::pmr::memory_resource> resource)
+      : resource_(std::move(resource)) {}
+  template <class U>
+  TreeAllocator(const TreeAllocator<U>& other) : resource_(other.resource_) {}
+
+  T* allocate(std::size_t n) {
+    return static_cast<T*>(resource_->allocate(n * sizeof(T), alignof(T)));
+  }
+  void deallocate(T* p, std::size_t n) {
+    resource_->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  template <class U>
+  bool operator==(const TreeAllocator<U>& other) const {
+    return resource_ == other.resource_;
+  }
+  template <class U>
+  bool operator!=(const TreeAllocator<U>& other) const {
+    return resource_ != other.resource_;
+  }
+
+ private:
+  template <class U>
+  friend class TreeAllocator;
+  std::shared_ptr<std::pmr::memory_resource> resource_;
+};
+
+/// Allocates an object owned by an evaluable tree, i.e nodes and their
+/// symbol tables, from resource of tree being translated
+template <class T, class... _Args>
+std::shared_ptr<T> makeTreeShared(_Args&&... args) {
+  if (auto& resource = treeMemoryResource()) {
+    return std::allocate_shared<T>(TreeAllocator<T>{resource},
+                                   std::forward<_Args>(args)...);
+  }
+  return std::make_shared<T>(std::forward<_Args>(args)...);
+}
+
+/// Type of a value proven at translate time
+enum class StaticType : char {
+  unknown,
+  boolean,
+  number,
+  string,
+  list,
+  dict,
+};
+
 using EvaluablePtr = std::shared_ptr<Evaluable>;
 using MacroPtr = std::shared_ptr<Macro>;
 
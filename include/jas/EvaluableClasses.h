@@ -15,6 +15,7 @@
 namespace jas {
 
 struct VariableEvalInfo;
+struct FieldPredicate;
 using Evaluables = std::vector<EvaluablePtr>;
 using LocalVariables = std::map<String, VariableEvalInfo, std::less<>>;
 using LocalVariablesPtr = std::shared_ptr<LocalVariables>;
@@ -23,11 +24,14 @@ using LocalMacrosMapPtr = std::shared_ptr<LocalMacrosMap>;
 
 struct VariableEvalInfo {
   enum Type { Declaration, Update };
-  VariableEvalInfo(EvaluablePtr v, Type tp = Declaration)
-      : value(std::move(v)), type(tp) {}
+  VariableEvalInfo(EvaluablePtr v, Type tp = Declaration,
+                   bool onDemand = false)
+      : value(std::move(v)), type(tp), onDemand(onDemand) {}
 
   EvaluablePtr value;
   Type type;
+  /// evaluated on its first read instead of on entering its scope
+  bool onDemand;
 };
 
 class Macro {
@@ -129,6 +133,30 @@ struct EvaluableList : public StacklessEvaluableT<EvaluableList> {
   ValueType value;
 };
 
+inline OStream& operator<<(OStream& os, StaticType t) {
+  switch (t) {
+    case StaticType::boolean:
+      os << "boolean";
+      break;
+    case StaticType::number:
+      os << "number";
+      break;
+    case StaticType::string:
+      os << "string";
+      break;
+    case StaticType::list:
+      os << "list";
+      break;
+    case StaticType::dict:
+      os << "dict";
+      break;
+    default:
+      os << "unknown";
+      break;
+  }
+  return os;
+}
+
 template <class _SubType, class _Type>
 struct _OperatorBase : public UseStackEvaluableT<_SubType> {
   using Param = Evaluable;
@@ -144,6 +172,9 @@ struct _OperatorBase : public UseStackEvaluableT<_SubType> {
 
   OperatorType type;
   Params params;
+  /// operands are proven to be of this type by translate-time passes, the
+  /// evaluator reads them as such without checking
+  StaticType operandType = StaticType::unknown;
 
   // UseStackEvaluable interface
  public:
@@ -365,6 +396,9 @@ inline OStream& operator<<(OStream& os, lsaot o) {
 }
 
 struct ListAlgorithm : public UseStackEvaluableT<ListAlgorithm> {
+  /// How items of `list` are produced: by evaluating it to a list, or one by
+  /// one by a fused filter/transform stage or by a range
+  enum class Source { list, stage, range };
   ListAlgorithm(Evaluable* parent, lsaot t, EvaluablePtr c,
                 EvaluablePtr list = {}, LocalVariablesPtr cp = {})
       : UseStackEvaluableT<ListAlgorithm>(parent, std::move(cp)),
@@ -375,6 +409,9 @@ struct ListAlgorithm : public UseStackEvaluableT<ListAlgorithm> {
   lsaot type;
   EvaluablePtr list;
   EvaluablePtr cond;
+  /// `cond` compiled to a native comparison of item fields with constants
+  std::shared_ptr<const FieldPredicate> fieldPredicate;
+  Source source = Source::list;
 
   // UseStackEvaluable interface
  public:
@@ -469,81 +506,81 @@ struct ContextArgumentsInfo : public StacklessEvaluableT<ContextArgumentsInfo> {
 
 template <class T>
 inline auto makeConst(Evaluable* parent, T&& val) {
-  return std::make_shared<Constant>(parent, std::forward<T>(val));
+  return makeTreeShared<Constant>(parent, std::forward<T>(val));
 }
 inline auto makeOp(Evaluable* parent, aot op, Evaluables params = {},
                    LocalVariablesPtr cp = {}) {
-  return std::make_shared<ArithmaticalOperator>(parent, op, std::move(params),
+  return makeTreeShared<ArithmaticalOperator>(parent, op, std::move(params),
                                                 std::move(cp));
 }
 
 inline auto makeOp(Evaluable* parent, asot op, Evaluables params = {},
                    LocalVariablesPtr cp = {}) {
-  return std::make_shared<ArthmSelfAssignOperator>(
+  return makeTreeShared<ArthmSelfAssignOperator>(
       parent, op, std::move(params), std::move(cp));
 }
 inline auto makeOp(Evaluable* parent, lot op, Evaluables params = {},
                    LocalVariablesPtr cp = {}) {
-  return std::make_shared<LogicalOperator>(parent, op, std::move(params),
+  return makeTreeShared<LogicalOperator>(parent, op, std::move(params),
                                            std::move(cp));
 }
 inline auto makeOp(Evaluable* parent, cot op, Evaluables params = {},
                    LocalVariablesPtr cp = {}) {
-  return std::make_shared<ComparisonOperator>(parent, op, std::move(params),
+  return makeTreeShared<ComparisonOperator>(parent, op, std::move(params),
                                               std::move(cp));
 }
 inline auto makeOp(Evaluable* parent, lsaot op, EvaluablePtr cond = {},
                    EvaluablePtr list = {}, LocalVariablesPtr cp = {}) {
-  return std::make_shared<ListAlgorithm>(parent, op, std::move(cond),
+  return makeTreeShared<ListAlgorithm>(parent, op, std::move(cond),
                                          std::move(list), std::move(cp));
 }
 
 template <class _FI>
 inline auto makeSimpleFI(Evaluable* parent, String name,
                          EvaluablePtr param = {}, LocalVariablesPtr cp = {}) {
-  return std::make_shared<_FI>(parent, std::move(name), std::move(param),
+  return makeTreeShared<_FI>(parent, std::move(name), std::move(param),
                                std::move(cp));
 }
 
 inline auto makeModuleFI(Evaluable* parent, String name,
                          FunctionModulePtr mdl = {}, EvaluablePtr param = {},
                          LocalVariablesPtr cp = {}) {
-  return std::make_shared<ModuleFI>(parent, std::move(name), std::move(param),
+  return makeTreeShared<ModuleFI>(parent, std::move(name), std::move(param),
                                     std::move(mdl), std::move(cp));
 }
 
 inline auto makeMacroFI(Evaluable* parent, String name, MacroPtr macro,
                         EvaluablePtr param = {},
                         LocalVariablesPtr stackVars = {}) {
-  return std::make_shared<MacroFI>(parent, std::move(name), std::move(macro),
+  return makeTreeShared<MacroFI>(parent, std::move(name), std::move(macro),
                                    std::move(param), std::move(stackVars));
 }
 
 inline auto makeVariable(Evaluable* parent, String name) {
-  return std::make_shared<Variable>(parent, std::move(name));
+  return makeTreeShared<Variable>(parent, std::move(name));
 }
 
 inline auto makeCtxtArg(Evaluable* parent, uint8_t pos) {
-  return std::make_shared<ContextArgument>(parent, pos);
+  return makeTreeShared<ContextArgument>(parent, pos);
 }
 
 inline auto makeCtxtArgInfo(Evaluable* parent,
                             ContextArgumentsInfo::Type type) {
-  return std::make_shared<ContextArgumentsInfo>(parent, type);
+  return makeTreeShared<ContextArgumentsInfo>(parent, type);
 }
 
 inline auto makeVariableFieldQuery(Evaluable* parent, EvaluablePtr variable,
                                    std::vector<EvaluablePtr> paths) {
-  return std::make_shared<ObjectPropertyQuery>(parent, std::move(variable),
+  return makeTreeShared<ObjectPropertyQuery>(parent, std::move(variable),
                                                std::move(paths));
 }
 
 inline auto makeEvbDict(Evaluable* parent, EvaluableDict::ValueType v = {}) {
-  return std::make_shared<EvaluableDict>(parent, std::move(v));
+  return makeTreeShared<EvaluableDict>(parent, std::move(v));
 }
 
 inline auto makeEvbList(Evaluable* parent, EvaluableList::ValueType v = {}) {
-  return std::make_shared<EvaluableList>(parent, std::move(v));
+  return makeTreeShared<EvaluableList>(parent, std::move(v));
 }
 
 }  // namespace jas
@@ -18,6 +18,12 @@ class FunctionModuleIF {
                    SyntaxEvaluatorImpl*) = 0;
   virtual bool has(const StringView& funcName) const = 0;
   virtual void enumerateFuncs(FunctionNameList& funcName) const = 0;
+  /// Pure function modifies neither its arguments nor any other state
+  virtual bool functionIsPure(const StringView&) const { return false; }
+  /// Type of values returned by function if it is always the same
+  virtual StaticType functionReturnType(const StringView&) const {
+    return StaticType::unknown;
+  }
 };
 
 __mc_jas_exception(FunctionNotFoundError);
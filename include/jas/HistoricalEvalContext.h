@@ -1,17 +1,70 @@
 #pragma once
 
+#include <functional>
+#include <iosfwd>
 #include <map>
+#include <memory>
+#include <set>
+#include <unordered_map>
 
 #include "BasicEvalContext.h"
+#include "SnapshotHistory.h"
 #include "String.h"
 
 namespace jas {
 
+class SnapshotDiff;
+
+/// Values of the stored variables of an evaluation, by interned paths of
+/// their contexts. It is persisted as a dict of `context/path/variable`, or
+/// incrementally as an append-only log
+class EvalResultStore {
+ public:
+  using ContextKey = size_t;
+
+  ContextKey keyOf(const String& contextPath);
+  const Var* get(ContextKey key, const StringView& variableName) const;
+  void put(ContextKey key, const String& variableName, Var value);
+  Var toVar();
+  static std::shared_ptr<EvalResultStore> fromVar(const Var& stored);
+
+  /// Appends variables put with new values since the log was last written
+  bool appendLog(OStream& ostrm);
+  /// Writes all variables as a new, compacted log
+  bool writeLog(OStream& ostrm);
+  /// The log has grown much larger than the variables it holds or is
+  /// damaged, so it should be rewritten with writeLog
+  bool compactionDue() const;
+  /// Reads a log up to its first damaged record. Variables of a context are
+  /// parsed when its path is first looked up
+  static std::shared_ptr<EvalResultStore> fromLog(IStream& istrm);
+
+ private:
+  using Variables = std::map<String, Var, std::less<>>;
+  using VariableNames = std::set<String, std::less<>>;
+  void loadAll();
+
+  std::unordered_map<String, ContextKey> keys_;
+  std::vector<String> paths_;
+  std::vector<Variables> variables_;
+  std::vector<VariableNames> changed_;
+  /// Not yet parsed records of contexts not looked up
+  std::unordered_map<String, std::vector<String>> unparsed_;
+  size_t loggedRecords_ = 0;
+  bool damaged_ = false;
+};
+
+/// Paths a rule reads in the current and last snapshots
+struct SnapshotReads {
+  std::set<String> current;
+  std::set<String> last;
+};
+
 class HistoricalEvalContext : public BasicEvalContext {
   using _Base = BasicEvalContext;
 
  public:
-  using EvaluatedVariables = Var;
+  using EvaluatedVariables = EvalResultStore;
   using EvaluatedVariablesPtr = std::shared_ptr<EvaluatedVariables>;
   enum SnapshotIdx : size_t {
     SnapshotIdxNew = 0,
@@ -26,37 +79,77 @@ class HistoricalEvalContext : public BasicEvalContext {
   HistoricalEvalContext(HistoricalEvalContext* p = nullptr,
                         Var currentSnapshot = {}, Var lastSnapshot = {},
                         String id = {});
+  /// Context on a history of snapshots, its latest two are the current and
+  /// last snapshots and older ones are read by their negative age
+  HistoricalEvalContext(HistoricalEvalContext* p,
+                        std::shared_ptr<const SnapshotHistory> history,
+                        String id = {});
   ~HistoricalEvalContext();
 
   static std::shared_ptr<HistoricalEvalContext> make(
       HistoricalEvalContext* p = nullptr, Var currentSnapshot = {},
       Var lastSnapshot = {}, String id = {});
+  /// Context on views of json snapshots, their nodes are converted when
+  /// first read
+  static std::shared_ptr<HistoricalEvalContext> make(
+      HistoricalEvalContext* p, std::shared_ptr<const Json> currentSnapshot,
+      std::shared_ptr<const Json> lastSnapshot = {}, String id = {});
 
   const EvaluatedVariablesPtr& lastEvalResult();
   void setLastEvalResult(EvaluatedVariablesPtr res);
   void syncEvalResult();
   bool saveEvaluationResult(OStream& ostrm);
   bool loadEvaluationResult(IStream& istrm);
+  /// Same as above in MessagePack, see VarCodec.h. Loaded values are decoded
+  /// when first read
+  bool saveEvaluationResultBinary(std::ostream& ostrm);
+  bool loadEvaluationResultBinary(std::istream& istrm);
+  /// Result that the last evaluation on this context stored, as long as it
+  /// was of the same rule, whose digest is `ruleDigest`, and the values at
+  /// the paths it reads are the same as then. Otherwise it is `evaluate`d
+  /// and stored in place of it. Only a digest of the rule and values is
+  /// stored with it, under a name that `last_eval` does not read
+  Var reuseOrEvaluate(const String& ruleDigest, const SnapshotReads& reads,
+                      const std::function<Var()>& evaluate);
+  /// Reads `path` of `snidx` snapshot of a list item the same way as field
+  /// functions invoked in the sub context of that item. Returns false if
+  /// item has no data, then field functions fall back to parent context
+  static bool itemField(const Var& item, const String& path,
+                        SnapshotIdx snidx, Var& value);
   std::vector<String> supportedFunctions() const override;
   bool functionSupported(const StringView& functionName) const override;
+  bool functionIsPure(const StringView& functionName) const override;
   Var invoke(const String& funcName, const Var& param) override;
 
  private:
   EvaluatedVariablesPtr lastEvalResult_;
+  std::unique_ptr<SnapshotDiff> snapshotDiff_;
+  std::shared_ptr<const SnapshotHistory> history_;
+  String contextPath_;
+  EvalResultStore::ContextKey contextKey_ = 0;
+  const EvalResultStore* keyedIn_ = nullptr;
+
+  SnapshotDiff& snapshotDiff();
+  EvalResultStore::ContextKey contextKey();
 
   Var snapshotValue(const String& path, const String& snapshot) const;
-  Var snapshotValue(const String& path,
-                    const SnapshotIdx snidx = SnapshotIdxNew) const;
+  Var snapshotValue(const String& path, size_t age = SnapshotIdxNew) const;
+  size_t snapshotCount() const;
+  /// Values of `path` in the last snapshots, the oldest first
+  Var snapshotWindow(const Var& params);
   EvalContextPtr subContext(const String& ctxtID,
                             ContextArguments input) override;
+  bool rebind(const String& ctxtID, ContextArguments input) override;
   bool hasData() const;
   HistoricalEvalContext* parent() const;
-  String contextPath() const;
-  String contextPath(const String& variableName) const;
+  static String contextPathOf(const HistoricalEvalContext* parent,
+                              const String& id);
 
   // context invocable methods
   /// check snapshot changed
   Var snchg(const Var& jpath);
+  /// paths changed, added or removed between snapshots
+  Var changed_paths(const Var& path);
   /// check whether evaluated value differs with its last evaluation or not
   Var evchg(const Var& json);
   Var field(const Var& params);
@@ -64,6 +157,8 @@ class HistoricalEvalContext : public BasicEvalContext {
   Var field_cv(const Var& path);
   Var hfield2arr(const Var& params);
   Var hfield(const Var& params);
+  Var hfield_window(const Var& params);
+  Var hfield_rate(const Var& params);
   Var last_eval(const Var& jVarName);
   Var _hfield(const String& path, const String& iid);
 
@@ -1,6 +1,8 @@
 /// Context Independent Functions
 #pragma once
 
+#include <functional>
+
 #include "Var.h"
 
 namespace jas {
@@ -29,6 +31,10 @@ Var is_odd(const Var&);
 Var empty(const Var&);
 Var not_empty(const Var&);
 Var abs(const Var&);
+Var range(const Var&);
+/// Walks through numbers of `range` without building the list, stops when
+/// `yield` returns false. Returns false if it was stopped
+bool range(const Var&, const std::function<bool(const Number&)>& yield);
 
 }  // namespace cif
 }  // namespace mdl
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+
+#include "String.h"
+
+namespace jas {
+
+/// Text of a snapshot file, memory mapped where supported. Pages of a mapped
+/// file are read when touched and, as they are never modified, the system
+/// may drop them under memory pressure
+class SnapshotFile {
+ public:
+  /// Null if the file cannot be read
+  static std::shared_ptr<const SnapshotFile> open(
+      const std::filesystem::path& path);
+  ~SnapshotFile();
+  SnapshotFile(const SnapshotFile&) = delete;
+  SnapshotFile& operator=(const SnapshotFile&) = delete;
+
+  StringView text() const;
+  /// Drops the pages read so far, they are read again when touched
+  void dropPages() const;
+
+ private:
+  SnapshotFile() = default;
+
+  void* mapped_ = nullptr;
+  size_t mappedSize_ = 0;
+  /// the text read, where files are not mapped
+  String read_;
+};
+
+}  // namespace jas
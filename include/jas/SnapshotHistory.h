@@ -0,0 +1,29 @@
+#pragma once
+
+#include <deque>
+
+#include "Var.h"
+
+namespace jas {
+
+/// The last snapshots of input data, up to a capacity. A pushed snapshot
+/// shares the subtrees it has in common with the one before it, so each
+/// snapshot held costs the parts that changed only
+class SnapshotHistory {
+ public:
+  explicit SnapshotHistory(size_t capacity = 2);
+
+  /// Adds the latest snapshot, dropping the oldest one when full
+  void push(Var snapshot);
+  /// Snapshot `age` pushes before the latest one, null if not held
+  const Var& at(size_t age) const;
+  size_t size() const;
+  size_t capacity() const;
+
+ private:
+  /// latest first
+  std::deque<Var> snapshots_;
+  size_t capacity_;
+};
+
+}  // namespace jas
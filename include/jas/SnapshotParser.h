@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <vector>
+
+#include "SnapshotFile.h"
+#include "Var.h"
+
+namespace jas {
+
+/// Paths of a snapshot to convert when parsing its json text, each keeping
+/// its whole subtree. An empty path keeps the whole snapshot
+class SnapshotProjection {
+ public:
+  /// Keeps the whole snapshot
+  SnapshotProjection();
+  explicit SnapshotProjection(const std::set<String>& paths);
+  bool keepsAll() const;
+
+ private:
+  friend class SnapshotParser;
+  struct Node {
+    std::map<String, size_t, std::less<>> children;
+    bool keepsAll = false;
+  };
+  /// the root first
+  std::vector<Node> nodes_;
+};
+
+/// Parses the json text of a snapshot to Var, skipping the subtrees out of
+/// `projection`: members of dicts are left out and items of lists are null,
+/// so indices of the kept ones stay the same. Skipped subtrees are checked
+/// for balanced brackets only. Returns null if the text is malformed
+Var parseSnapshot(const StringView& text,
+                  const SnapshotProjection& projection = {});
+/// Snapshot of json `text` held by `holder`, whose dicts and lists are each
+/// decoded when first accessed. Malformed ones are null
+Var lazySnapshot(const StringView& text, std::shared_ptr<const void> holder);
+Var lazySnapshot(std::shared_ptr<const SnapshotFile> file);
+
+}  // namespace jas
@@ -11,16 +11,28 @@ namespace jas {
 using DebugOutputCallback = std::function<void(const String&)>;
 class ModuleManager;
 class Evaluable;
+struct CompiledProgram;
 class SyntaxEvaluator {
  public:
+  enum class Engine {
+    Interpreter,
+    /// evaluable trees are compiled to closures on their first evaluation,
+    /// debug info callback falls back to the interpreter
+    Closures,
+  };
+
   SyntaxEvaluator();
   ~SyntaxEvaluator();
   Var evaluate(const Evaluable& e, EvalContextPtr rootContext = nullptr);
   Var evaluate(const EvaluablePtr& e, EvalContextPtr rootContext = nullptr);
 
   void setDebugInfoCallback(DebugOutputCallback);
+  void setEngine(Engine engine);
+  Engine engine() const;
 
  private:
   class SyntaxEvaluatorImpl* impl_ = nullptr;
+  Engine engine_ = Engine::Interpreter;
+  std::shared_ptr<CompiledProgram> program_;
 };
 }  // namespace jas
@@ -1,6 +1,7 @@
 #pragma once
 
 #include <functional>
+#include <memory_resource>
 
 #include "EvalContextIF.h"
 #include "EvaluableClasses.h"
@@ -14,6 +15,15 @@ class Evaluable;
 class EvaluationStack;
 class EvaluationFrame;
 using EvaluationFramePtr = std::shared_ptr<EvaluationFrame>;
+struct CompiledNode;
+struct CompiledProgram;
+struct EvaluatedOnReadValue;
+using EvaluatedOnReadValues = std::pmr::vector<EvaluatedOnReadValue>;
+using ListItemConsumer = std::function<bool(const Var&)>;
+class SyntaxEvaluatorImpl;
+/// Applies an operator to its operands
+using OperatorApplier = Var (*)(SyntaxEvaluatorImpl&, const Evaluable&,
+                                const EvaluatedOnReadValues&);
 
 class SyntaxEvaluatorImpl : public EvaluatorIF {
  public:
@@ -28,6 +38,18 @@ class SyntaxEvaluatorImpl : public EvaluatorIF {
   EvaluationStack* stack_ = nullptr;
   DebugOutputCallback dbCallback_;
   int evalCount_ = 0;
+  int pendingVariables_ = 0;
+  /// Closures of the evaluated tree, invoked in place of its evaluables
+  const CompiledProgram* compiled_ = nullptr;
+  /// Buffer of operand vectors of operators, released at once at the end of
+  /// each evaluation. Other values, such as context arguments and list
+  /// algorithm results, outlive it and are allocated on their own
+  alignas(std::max_align_t) std::byte operandsBuffer_[4096];
+  std::pmr::monotonic_buffer_resource operandsArena_{operandsBuffer_,
+                                                     sizeof(operandsBuffer_)};
+  /// Operands are freed to pools of the arena and reused, for operators
+  /// evaluated over and over in loops not to grow it
+  std::pmr::unsynchronized_pool_resource operandPools_{&operandsArena_};
   //-----------------------------------------------
   void eval(const Constant& v) override;
   void eval(const EvaluableDict& v) override;
@@ -47,22 +69,67 @@ class SyntaxEvaluatorImpl : public EvaluatorIF {
   void eval(const ContextArgumentsInfo& arginf) override;
 
   Var* _findAndEvalNotInitializedVariableOrThrow(const String& variableName);
+  Var* _evalIfPendingVariable(const String& variableName, Var* val);
   void _evalOnStack(const Evaluable* e, String ctxtID = {},
                     ContextArguments ctxtInput = {});
   Var evalAndReturn(const Evaluable* e, String ctxtID = {},
                     ContextArguments ctxtData = {});
+  /// Evaluates `e` against one item of a list on a frame of its own, even if
+  /// `e` is stackless. `itemFrame` starts empty and is kept by caller across
+  /// items, its context is then rebound to each next item instead of being
+  /// recreated
+  Var evalAndReturnOnItem(EvaluationFramePtr& itemFrame, const Evaluable* e,
+                          String ctxtID, ContextArguments item,
+                          const CompiledNode* compiled = nullptr);
+  /// Invokes closure of `node` on a frame identified by `frameID`
+  Var evalCompiledOnStack(const CompiledNode& node, String frameID,
+                          ContextArguments ctxtData = {});
+  /// Evaluations shared by the interpreter and closures, `compiled` is the
+  /// closure of the evaluable if any, of which operands are invoked in place
+  /// of its children
+  Var evalListAlgorithm(const ListAlgorithm& op, const CompiledNode* compiled);
+  Var evalSelfAssign(const ArthmSelfAssignOperator& op,
+                     const CompiledNode* compiled);
+  Var evalPropertyQuery(const ObjectPropertyQuery& query,
+                        const CompiledNode* compiled);
+  /// Feeds items of `list` of a list algorithm to `consume` until it returns
+  /// false, returns false if it was stopped
+  bool feedListItems(const ListAlgorithm& op, const ListItemConsumer& consume,
+                     const CompiledNode* compiled = nullptr);
+  bool feedStageItems(const ListAlgorithm& stage, String ctxtID,
+                      const ListItemConsumer& consume,
+                      const CompiledNode* compiled);
+  bool feedRangeItems(const ModuleFI& range, String ctxtID,
+                      const ListItemConsumer& consume,
+                      const CompiledNode* compiled);
   template <class _Exception, typename... _Msg>
   void stackUnwindThrow(_Msg&&...);
 
+  const CompiledNode* compiledOf(const Evaluable* e) const;
   inline void debugStackReturnedValue(const Var& e, const Evaluable* evb);
   Var& stackReturnedVal();
   Var stackTakeReturnedVal();
   Var* evaluateSingleVar(const EvaluationFramePtr& frame, const String& varname,
-                         const VariableEvalInfo& vi);
+                         const VariableEvalInfo& vi,
+                         const CompiledNode* compiled = nullptr);
   void evaluateLocalSymbols(const UseStackEvaluable& evb);
   String generateBackTrace(const String& msg) const;
 
   /// Evaluations:
+  Var applyOperator(const ArithmaticalOperator& op,
+                    const EvaluatedOnReadValues& operands);
+  Var applyOperator(const LogicalOperator& op,
+                    const EvaluatedOnReadValues& operands);
+  Var applyOperator(const ComparisonOperator& op,
+                    const EvaluatedOnReadValues& operands);
+  /// Appliers of operators, typed ones if operand types are proven. Closures
+  /// bind them once, the interpreter picks them on each evaluation
+  static OperatorApplier applierOf(const ArithmaticalOperator& op);
+  static OperatorApplier applierOf(const LogicalOperator& op);
+  static OperatorApplier applierOf(const ComparisonOperator& op);
+  /// Reports type errors thrown by `apply` as evaluation errors of `op`
+  template <class _Operator, class _Apply>
+  Var applyReportingTypeErrors(const _Operator& op, _Apply&& apply);
   template <class _Operator, class _Callable>
   Var evaluateOperator(const _Operator& op, _Callable&& eval_func);
   template <class _ComparisonMethod, size_t expected_count, class _Operation>
@@ -8,6 +8,7 @@
 namespace jas {
 using ContextPtr = std::shared_ptr<class EvalContextIF>;
 class ModuleManager;
+struct SnapshotReads;
 struct TranslatorImpl;
 
 class Translator {
@@ -17,12 +18,54 @@ class Translator {
     Formal,
   };
 
+  /// Translate-time passes applied on translated evaluables
+  struct Optimizations {
+    /// substitute small macros' bodies for their invocations
+    bool inlineMacros = false;
+    bool eliminateCommonSubexpressions = false;
+    /// evaluate side-effect free variables on their first read
+    bool lazyLocalVariables = false;
+    /// evaluate operators of statically typed operands without type dispatch
+    bool inferTypes = false;
+    /// test list algorithm conditions that compare item fields with
+    /// constants natively
+    bool fieldPredicates = false;
+    /// consume items of filter/transform stages and ranges one by one
+    /// instead of building intermediate lists
+    bool fuseListPipelines = false;
+    /// allocate nodes of a translated tree from a single buffer, released
+    /// together with the tree root
+    bool arenaAllocation = false;
+    /// extract the snapshot paths a rule reads, for evaluations to reuse its
+    /// last result while the values at those paths stay the same
+    bool reuseUnchangedResults = false;
+    /// extract the snapshot paths a rule reads, for loaders to parse only
+    /// those paths of snapshot json texts
+    bool projectSnapshots = false;
+  };
+
+  /// Statistics of the last translation
+  struct Report {
+    size_t inlinedMacroInvocations = 0;
+    size_t deduplicatedNodes = 0;
+    size_t deferredVariables = 0;
+    size_t specializedOperators = 0;
+    size_t compiledPredicates = 0;
+    size_t fusedPipelineStages = 0;
+  };
+
   Translator(ModuleManager* moduleMgr);
   ~Translator();
   EvaluablePtr translate(EvalContextPtr ctxt, const Var& jas,
                          Strategy strategy = Strategy::AllowShorthand);
   Var reconstructJAS(EvalContextPtr ctxt, const Var& script);
   static const std::set<StringView>& evaluableSpecifiers();
+  void setOptimizations(const Optimizations& optimizations);
+  const Optimizations& optimizations() const;
+  const Report& lastReport() const;
+  /// Snapshot paths read by the last translated rule, null if they were not
+  /// extracted or are not statically known
+  std::shared_ptr<const SnapshotReads> snapshotReads() const;
 
   TranslatorImpl* impl_ = nullptr;
 };  // namespace parser
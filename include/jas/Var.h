@@ -1,5 +1,6 @@
 #pragma once
 
+#include <functional>
 #include <map>
 #include <vector>
 
@@ -24,6 +25,14 @@ class Var {
   using PathView = jas::PathView;
   using ValuePtr = std::shared_ptr<ValueType>;
   struct Null {};
+  /// Source of a lazy value, such as an encoded json that is decoded on
+  /// demand
+  class Source {
+   public:
+    virtual ~Source() = default;
+    /// The value, its children may be lazy values of other sources
+    virtual Var convert() const = 0;
+  };
 
   Var();
   Var(List list);
@@ -79,6 +88,13 @@ class Var {
   static Var ref(Var rf = {});
   static Var list(List list = {});
   static Var dict(Dict dict = {});
+  /// Value of `source`, converted in place when it is first accessed. It may
+  /// be read by several threads, `source` may then be converted more than
+  /// once but only one conversion is kept
+  static Var lazy(std::shared_ptr<const Source> source);
+  /// Read-only view of a json, its nodes are converted to values when first
+  /// accessed. The json is never modified, modifications apply to the values
+  static Var view(std::shared_ptr<const Json> json);
 
   size_t typeID() const;
   bool isNumber() const;
@@ -134,9 +150,16 @@ class Var {
   void becomeNull();
   Json toJson() const;
   String dump() const;
+  /// Structural hash of the value, equal values have equal hashes. It is
+  /// cached on lists and dicts converted from json, such as snapshots, until
+  /// they are accessed for modification
+  size_t hash() const;
 
  private:
   static ValuePtr fromJson(const Json& json);
+  /// Converts a lazy value in place, safe with concurrent const accessors
+  static void materialize(const ValuePtr& value);
+  size_t structuralHash(bool& cacheable) const;
   friend bool operator==(const Var& first, const Var& second);
   friend bool operator!=(const Var& first, const Var& secondr);
   friend bool operator<(const Var& first, const Var& second);
@@ -217,3 +240,10 @@ auto Var::visitValue(_callable&& apply, bool throwWhenNull) const {
   }
 }
 }  // namespace jas
+
+namespace std {
+template <>
+struct hash<jas::Var> {
+  size_t operator()(const jas::Var& var) const { return var.hash(); }
+};
+}  // namespace std
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <memory>
+#include <string>
+#include <string_view>
+
+#include "Var.h"
+
+namespace jas {
+
+/// Appends `value` encoded in MessagePack, integers and doubles keep their
+/// types. Strings are encoded in UTF-8
+void encodeVar(const Var& value, std::string& out);
+std::string encodeVar(const Var& value);
+/// Decodes a MessagePack encoded value, null if `data` is malformed
+Var decodeVar(std::string_view data);
+/// Value of MessagePack `data` held by `holder`, whose maps and arrays are
+/// each decoded from it when first accessed. Malformed ones are null
+Var lazyDecodeVar(std::string_view data, std::shared_ptr<const void> holder);
+/// 128-bit digest of the encoding of `value`, as 32 hex digits. Values equal
+/// in their types have equal digests
+String digestVar(const Var& value);
+
+}  // namespace jas
@@ -1,5 +1,7 @@
 #include "jas/BasicEvalContext.h"
 
+#include <typeinfo>
+
 #include "jas/Exception.h"
 #include "jas/FunctionModule.h"
 #include "jas/Keywords.h"
@@ -24,6 +26,13 @@ bool BasicEvalContext::functionSupported(const StringView &functionName) const {
   return false;
 }
 
+bool BasicEvalContext::functionIsPure(const StringView &functionName) const {
+  if (parent_) {
+    return parent_->functionIsPure(functionName);
+  }
+  return false;
+}
+
 Var BasicEvalContext::invoke(const String &funcName, const Var &param) {
   if (parent_) {
     try {
@@ -80,6 +89,21 @@ EvalContextPtr BasicEvalContext::subContext(const String &ctxtID,
   return make_shared<BasicEvalContext>(this, ctxtID, move(args));
 }
 
+bool BasicEvalContext::rebind(const String &ctxtID, ContextArguments input) {
+  // subclasses may create their sub contexts otherwise
+  if (typeid(*this) != typeid(BasicEvalContext)) {
+    return false;
+  }
+  retarget(ctxtID, move(input));
+  return true;
+}
+
+void BasicEvalContext::retarget(const String &ctxtID, ContextArguments input) {
+  id_ = ctxtID;
+  args_ = move(input);
+  variables_.clear();
+}
+
 String BasicEvalContext::debugInfo() const { return id_; }
 
 const BasicEvalContext *BasicEvalContext::rootContext() const {
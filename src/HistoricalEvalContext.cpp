@@ -2,11 +2,19 @@
 
 #include <algorithm>
 #include <cassert>
+#include <istream>
+#include <iterator>
 #include <memory>
+#include <set>
+#include <typeinfo>
+#include <unordered_map>
 
+#include "details/EvalResultLog.h"
+#include "details/SnapshotDiff.h"
 #include "jas/Exception.h"
 #include "jas/FunctionModule.h"
 #include "jas/Keywords.h"
+#include "jas/VarCodec.h"
 
 #define __ctxtm(methodName) &HistoricalEvalContext::methodName
 
@@ -18,11 +26,14 @@ namespace func_name {
 using namespace std::string_view_literals;
 inline constexpr auto evchg = JASSTR("evchg");
 inline constexpr auto snchg = JASSTR("snchg");
+inline constexpr auto changed_paths = JASSTR("changed_paths");
 inline constexpr auto field = JASSTR("field");
 inline constexpr auto field_cv = JASSTR("field_cv");
 inline constexpr auto field_lv = JASSTR("field_lv");
 inline constexpr auto hfield = JASSTR("hfield");
 inline constexpr auto hfield2arr = JASSTR("hfield2arr");
+inline constexpr auto hfield_window = JASSTR("hfield_window");
+inline constexpr auto hfield_rate = JASSTR("hfield_rate");
 inline constexpr auto last_eval = JASSTR("last_eval");
 }  // namespace func_name
 
@@ -31,16 +42,23 @@ namespace {
 static const auto path = JASSTR("path");
 static const auto iid = JASSTR("iid");
 static const auto snapshot = JASSTR("snapshot");
+static const auto size = JASSTR("size");
 static const auto snlst = JASSTR("last");
 static const auto sncur = JASSTR("cur");
 static const auto h_field_cur = JASSTR("current_field__");
 static const auto h_field_lst = JASSTR("last_field__");
 static const auto path_sep = JASSTR("/");
+/// names of records kept by evaluations themselves, not stored variables
+static const auto record_prefix = JASSTR('@');
+static const auto result = JASSTR("@result");
+static const auto result_digest = JASSTR("digest");
+static const auto result_value = JASSTR("value");
 }  // namespace
 }  // namespace cstr
 
 static HistoricalEvalContext::SnapshotIdx _toSnapshotIdx(
     const String& snapshot);
+static size_t _toSnapshotAge(const Var& snapshot);
 static Var _makeHistoricalData(Var newd, Var oldd = {});
 static bool _hasHistoricalShape(const Var& data);
 
@@ -58,12 +76,15 @@ const HistoricalEvalContext::CtxtFunctionsMap&
 HistoricalEvalContext::funcsMap() {
   static const CtxtFunctionsMap funcs = {
       {func_name::snchg, __ctxtm(snchg)},
+      {func_name::changed_paths, __ctxtm(changed_paths)},
       {func_name::evchg, __ctxtm(evchg)},
       {func_name::field, __ctxtm(field)},
       {func_name::field_lv, __ctxtm(field_lv)},
       {func_name::field_cv, __ctxtm(field_cv)},
       {func_name::hfield, __ctxtm(hfield)},
       {func_name::hfield2arr, __ctxtm(hfield2arr)},
+      {func_name::hfield_window, __ctxtm(hfield_window)},
+      {func_name::hfield_rate, __ctxtm(hfield_rate)},
       {func_name::last_eval, __ctxtm(last_eval)},
   };
   return funcs;
@@ -71,12 +92,21 @@ HistoricalEvalContext::funcsMap() {
 
 HistoricalEvalContext::HistoricalEvalContext(HistoricalEvalContext* p,
                                              ContextArguments input, String id)
-    : _Base(p, move(id), move(input)) {}
+    : _Base(p, move(id), move(input)),
+      contextPath_(contextPathOf(p, id_)) {}
 
 HistoricalEvalContext::HistoricalEvalContext(HistoricalEvalContext* p,
                                              Var currentSnapshot,
                                              Var lastSnapshot, String id)
-    : _Base(p, move(id), {move(currentSnapshot), move(lastSnapshot)}) {}
+    : _Base(p, move(id), {move(currentSnapshot), move(lastSnapshot)}),
+      contextPath_(contextPathOf(p, id_)) {}
+
+HistoricalEvalContext::HistoricalEvalContext(
+    HistoricalEvalContext* p, std::shared_ptr<const SnapshotHistory> history,
+    String id)
+    : _Base(p, move(id), {history->at(0), history->at(1)}),
+      history_(move(history)),
+      contextPath_(contextPathOf(p, id_)) {}
 
 HistoricalEvalContext::~HistoricalEvalContext() { syncEvalResult(); }
 
@@ -87,6 +117,13 @@ std::shared_ptr<HistoricalEvalContext> HistoricalEvalContext::make(
                                             move(lastSnapshot), move(id));
 }
 
+std::shared_ptr<HistoricalEvalContext> HistoricalEvalContext::make(
+    HistoricalEvalContext* p, std::shared_ptr<const Json> currentSnapshot,
+    std::shared_ptr<const Json> lastSnapshot, String id) {
+  return make(p, Var::view(move(currentSnapshot)),
+              Var::view(move(lastSnapshot)), move(id));
+}
+
 bool HistoricalEvalContext::functionSupported(
     const StringView& functionName) const {
   if (funcsMap().find(functionName) != std::end(funcsMap())) {
@@ -96,6 +133,22 @@ bool HistoricalEvalContext::functionSupported(
   }
 }
 
+bool HistoricalEvalContext::functionIsPure(
+    const StringView& functionName) const {
+  // evchg and last_eval depend on variables of the invoking context
+  static const std::set<StringView> pureFuncs = {
+      func_name::snchg,    func_name::field,  func_name::field_lv,
+      func_name::field_cv, func_name::hfield, func_name::hfield2arr,
+      func_name::changed_paths, func_name::hfield_window,
+      func_name::hfield_rate,
+  };
+  if (funcsMap().find(functionName) != std::end(funcsMap())) {
+    return pureFuncs.find(functionName) != std::end(pureFuncs);
+  } else {
+    return _Base::functionIsPure(functionName);
+  }
+}
+
 Var HistoricalEvalContext::invoke(const String& funcName, const Var& param) {
   if (auto it = funcsMap().find(funcName); it != std::end(funcsMap())) {
     return (this->*(it->second))(param);
@@ -110,18 +163,71 @@ Var HistoricalEvalContext::snapshotValue(const String& path,
 }
 
 Var HistoricalEvalContext::snapshotValue(const String& path,
-                                         const SnapshotIdx snidx) const {
-  if (snidx < args_.size()) {
+                                         size_t age) const {
+  if (age < snapshotCount()) {
+    auto& snapshot = history_ ? history_->at(age) : args_[age];
     if (!path.empty()) {
-      return args_[snidx].getPath(path);
+      return snapshot.getPath(path);
     } else {
-      return args_[snidx];
+      return snapshot;
     }
   } else {
     return {};
   }
 }
 
+size_t HistoricalEvalContext::snapshotCount() const {
+  return history_ ? history_->size() : args_.size();
+}
+
+Var HistoricalEvalContext::snapshotWindow(const Var& params) {
+  String path;
+  auto size = snapshotCount();
+  if (params.isString()) {
+    path = params.asString();
+  } else {
+    __jas_func_throw_invalidargs_if(!params.isDict(),
+                                    "input must be string or object", params);
+    path = params.getAt(cstr::path).getString();
+    if (auto jsize = params.getAt(cstr::size); !jsize.isNull()) {
+      __jas_func_throw_invalidargs_if(!jsize.isInt() || jsize.getInt() < 1,
+                                      "size must be a positive integer",
+                                      jsize);
+      size = std::min<size_t>(size, jsize.getInt());
+    }
+  }
+  auto window = Var::list();
+  for (auto age = size; age > 0; --age) {
+    window.add(snapshotValue(path, age - 1));
+  }
+  return window;
+}
+
+bool HistoricalEvalContext::itemField(const Var& item, const String& path,
+                                      SnapshotIdx snidx, Var& value) {
+  const Var* snapshot = nullptr;
+  if (_hasHistoricalShape(item)) {
+    auto& current = item.at(cstr::h_field_cur);
+    auto& last = item.at(cstr::h_field_lst);
+    if (current.isNull() && last.isNull()) {
+      return false;
+    }
+    snapshot = snidx == SnapshotIdxNew ? &current : &last;
+  } else if (item.isNull()) {
+    return false;
+  } else if (snidx == SnapshotIdxNew) {
+    snapshot = &item;
+  }
+  if (!snapshot) {
+    value = Var{};
+  } else if (!path.empty()) {
+    value = snapshot->getPath(path);
+  } else {
+    value = *snapshot;
+  }
+  return true;
+}
+
 EvalContextPtr HistoricalEvalContext::subContext(const String& ctxtID,
                                                  ContextArguments input) {
   if ((input.size() == 1) && _hasHistoricalShape(input[0])) {
@@ -132,6 +238,25 @@ EvalContextPtr HistoricalEvalContext::subContext(const String& ctxtID,
   }
 }
 
+bool HistoricalEvalContext::rebind(const String& ctxtID,
+                                   ContextArguments input) {
+  // subclasses may create their sub contexts otherwise
+  if (typeid(*this) != typeid(HistoricalEvalContext)) {
+    return false;
+  }
+  // variables of the previous target are stored before they are cleared
+  syncEvalResult();
+  snapshotDiff_.reset();
+  if ((input.size() == 1) && _hasHistoricalShape(input[0])) {
+    input = {input[0].at(cstr::h_field_cur), input[0].at(cstr::h_field_lst)};
+  }
+  retarget(ctxtID, move(input));
+  history_.reset();
+  contextPath_ = contextPathOf(parent(), id_);
+  keyedIn_ = nullptr;
+  return true;
+}
+
 bool HistoricalEvalContext::hasData() const {
   return std::any_of(std::begin(args_), std::end(args_),
                      [](auto& sn) { return !sn.isNull(); });
@@ -146,29 +271,47 @@ HistoricalEvalContext* HistoricalEvalContext::parent() const {
   return nullptr;
 }
 
-String HistoricalEvalContext::contextPath() const {
-  if (parent()) {
-    return strJoin(parent()->contextPath(), cstr::path_sep, this->id_);
-  } else {
-    return this->id_;
-  }
+String HistoricalEvalContext::contextPathOf(
+    const HistoricalEvalContext* parent, const String& id) {
+  return parent ? strJoin(parent->contextPath_, cstr::path_sep, id) : id;
 }
 
-String HistoricalEvalContext::contextPath(const String& variableName) const {
-  return strJoin(contextPath(), cstr::path_sep, variableName);
+EvalResultStore::ContextKey HistoricalEvalContext::contextKey() {
+  auto& store = *lastEvalResult();
+  if (keyedIn_ != &store) {
+    contextKey_ = store.keyOf(contextPath_);
+    keyedIn_ = &store;
+  }
+  return contextKey_;
 }
 
 Var HistoricalEvalContext::snchg(const Var& jpath) {
   __mc_invokeOnParentIfNoData(snchg, false, jpath);
   auto path = jpath.getString();
 
-  if (path.empty()) {
-    return !args_.empty() && ((args_.size() == 1 /*has only new snapshot*/) ||
-                              (args_[SnapshotIdxNew] != args_[SnapshotIdxOld]));
-  } else {
-    return snapshotValue(path, SnapshotIdxNew) !=
-           snapshotValue(path, SnapshotIdxOld);
+  if (args_.empty()) {
+    return false;
+  }
+  if (path.empty() && args_.size() == 1 /*has only new snapshot*/) {
+    return true;
+  }
+  return snapshotDiff().changed(path);
+}
+
+Var HistoricalEvalContext::changed_paths(const Var& path) {
+  __mc_invokeOnParentIfNoData(changed_paths, Var{}, path);
+  __jas_func_throw_invalidargs_if(!path.isString() && !path.isNull(),
+                                  "input must be string or nothing", path);
+  return snapshotDiff().changedPaths(path.getString());
+}
+
+SnapshotDiff& HistoricalEvalContext::snapshotDiff() {
+  auto current = snapshotValue({}, SnapshotIdxNew);
+  auto last = snapshotValue({}, SnapshotIdxOld);
+  if (!snapshotDiff_ || !snapshotDiff_->of(current, last)) {
+    snapshotDiff_ = std::make_unique<SnapshotDiff>(move(current), move(last));
   }
+  return *snapshotDiff_;
 }
 
 Var HistoricalEvalContext::evchg(const Var& json) {
@@ -188,8 +331,8 @@ Var HistoricalEvalContext::evchg(const Var& json) {
 
   if (auto itVar = variables_.find(variableName);
       itVar != std::end(variables_)) {
-    auto& levr = *lastEvalResult();
-    changed = levr.getAt(contextPath(variableName)) != itVar->second;
+    auto last = lastEvalResult()->get(contextKey(), variableName);
+    changed = (last ? *last : Var{}) != itVar->second;
   } else if (parent_) {
     changed = parent()->evchg(variableName);
   } else {
@@ -206,7 +349,11 @@ Var HistoricalEvalContext::field(const Var& params) {
     path = params.asString();
   } else if (params.isDict()) {
     path = params.getAt(cstr::path).getString();
-    snapshot = params.getAt(cstr::snapshot).getString();
+    if (auto jsnapshot = params.getAt(cstr::snapshot); jsnapshot.isNumber()) {
+      return snapshotValue(path, _toSnapshotAge(jsnapshot));
+    } else {
+      snapshot = jsnapshot.getString();
+    }
   }
   return snapshotValue(path, snapshot);
 }
@@ -255,16 +402,37 @@ Var HistoricalEvalContext::hfield(const Var& params) {
   return _hfield(path, iid);
 }
 
+Var HistoricalEvalContext::hfield_window(const Var& params) {
+  __mc_invokeOnParentIfNoData(hfield_window, Var{}, params);
+  return snapshotWindow(params);
+}
+
+Var HistoricalEvalContext::hfield_rate(const Var& params) {
+  __mc_invokeOnParentIfNoData(hfield_rate, Var{}, params);
+  auto window = snapshotWindow(params);
+  if (window.size() < 2) {
+    return {};
+  }
+  auto& oldest = window[0];
+  auto& latest = window[window.size() - 1];
+  if (!oldest.isNumber() || !latest.isNumber()) {
+    return {};
+  }
+  return (latest.getValue<Var::Double>() - oldest.getValue<Var::Double>()) /
+         static_cast<Var::Double>(window.size() - 1);
+}
+
 Var HistoricalEvalContext::last_eval(const Var& jVarName) {
   __jas_func_throw_invalidargs_if(!jVarName.isString(),
                                   "Variable name must be string", jVarName);
   decltype(auto) variableName = jVarName.asString();
   __jas_ni_func_throw_invalidargs_if(variableName.empty(),
                                      "Variable name must not be empty");
-  auto& lastEvals = *lastEvalResult();
-  auto ctxtPath = contextPath(variableName);
-  if (lastEvals.contains(ctxtPath)) {
-    return lastEvals.getAt(ctxtPath);
+  if (variableName.front() == cstr::record_prefix) {
+    return {};
+  }
+  if (auto last = lastEvalResult()->get(contextKey(), variableName)) {
+    return *last;
   } else if (parent_) {
     return parent()->last_eval(jVarName);
   } else {
@@ -280,24 +448,40 @@ Var HistoricalEvalContext::_hfield(const String& path, const String& iid) {
   }
 
   // is array:
-  auto findItem = [&iid](const Var& list, const Var& itemIdVal) {
-    Var out;
-    for (auto& item : list.asList()) {
-      if (item.contains(iid) && item.getAt(iid) == itemIdVal) {
-        out = item;
-        break;
-      }
-    }
-    return out;
-  };
-
-  auto& newList = newd;
-  auto oldList = snapshotValue(path, SnapshotIdxOld);
+  const auto& newList = newd;
+  const auto oldList = snapshotValue(path, SnapshotIdxOld);
 
   if (!iid.empty()) {
+    // old items are indexed by their iid values, the first one of a value is
+    // paired, the ones not paired are reported as removed
+    std::unordered_map<Var, size_t> oldItemsIndex;
+    std::vector<bool> paired;
+    if (oldList.isList()) {
+      auto& oldItems = oldList.asList();
+      oldItemsIndex.reserve(oldItems.size());
+      paired.resize(oldItems.size(), false);
+      for (size_t i = 0; i < oldItems.size(); ++i) {
+        if (oldItems[i].isDict() && oldItems[i].contains(iid)) {
+          oldItemsIndex.emplace(oldItems[i].getAt(iid), i);
+        }
+      }
+    }
     auto output = Var::list();
     for (auto& newItem : newList.asList()) {
-      output.add(_makeHistoricalData(newItem, findItem(oldList, newItem[iid])));
+      Var oldItem;
+      if (newItem.isDict()) {
+        if (auto it = oldItemsIndex.find(newItem.getAt(iid));
+            it != std::end(oldItemsIndex)) {
+          oldItem = oldList[it->second];
+          paired[it->second] = true;
+        }
+      }
+      output.add(_makeHistoricalData(newItem, move(oldItem)));
+    }
+    for (size_t i = 0; i < paired.size(); ++i) {
+      if (!paired[i]) {
+        output.add(_makeHistoricalData({}, oldList[i]));
+      }
     }
     return output;
   } else {
@@ -321,14 +505,41 @@ Var HistoricalEvalContext::_hfield(const String& path, const String& iid) {
   }
 }
 
+Var HistoricalEvalContext::reuseOrEvaluate(
+    const String& ruleDigest, const SnapshotReads& reads,
+    const std::function<Var()>& evaluate) {
+  auto readValues = [this](const std::set<String>& paths, SnapshotIdx idx) {
+    Var::Dict values;
+    for (auto& path : paths) {
+      values.emplace(path, snapshotValue(path, idx));
+    }
+    return Var(move(values));
+  };
+  // the rule and the values read are stored as a fixed-size digest only
+  auto digest = Var(digestVar(Var::list(
+      {Var(ruleDigest), readValues(reads.current, SnapshotIdxNew),
+       readValues(reads.last, SnapshotIdxOld)})));
+  auto& store = *lastEvalResult();
+  auto key = contextKey();
+  if (auto last = store.get(key, cstr::result);
+      last && last->getAt(cstr::result_digest) == digest) {
+    return last->getAt(cstr::result_value);
+  }
+  auto result = evaluate();
+  // a single result is kept per context, the one of the rule last evaluated
+  store.put(key, cstr::result,
+            Var::dict({{cstr::result_digest, move(digest)},
+                       {cstr::result_value, result}}));
+  return result;
+}
+
 const HistoricalEvalContext::EvaluatedVariablesPtr&
 HistoricalEvalContext::lastEvalResult() {
   if (!lastEvalResult_) {
     if (parent_) {
       lastEvalResult_ = parent()->lastEvalResult();
     } else {
-      lastEvalResult_ =
-          make_shared<EvaluatedVariables>(EvaluatedVariables::dict());
+      lastEvalResult_ = make_shared<EvaluatedVariables>();
     }
   }
   return lastEvalResult_;
@@ -337,15 +548,16 @@ HistoricalEvalContext::lastEvalResult() {
 void HistoricalEvalContext::setLastEvalResult(
     HistoricalEvalContext::EvaluatedVariablesPtr res) {
   lastEvalResult_ = move(res);
+  keyedIn_ = nullptr;
 }
 
 void HistoricalEvalContext::syncEvalResult() {
   if (!variables_.empty()) {
     auto& evr = *lastEvalResult();
-    auto thisCtxtPath = contextPath();
+    auto key = contextKey();
     for (auto& [var, val] : variables_) {
       if (!val.isNull() && var.front() == TobeStoredVariablePrefix) {
-        evr[strJoin(thisCtxtPath, cstr::path_sep, var)] = val;
+        evr.put(key, var, val.isRef() ? *val.asRef() : val);
       }
     }
   }
@@ -354,7 +566,7 @@ void HistoricalEvalContext::syncEvalResult() {
 bool HistoricalEvalContext::saveEvaluationResult(OStream& ostrm) {
   syncEvalResult();
   if (auto res = lastEvalResult()) {
-    ostrm << JsonTrait::dump(res->toJson());
+    ostrm << JsonTrait::dump(res->toVar().toJson());
     return true;
   }
   return false;
@@ -363,7 +575,30 @@ bool HistoricalEvalContext::saveEvaluationResult(OStream& ostrm) {
 bool HistoricalEvalContext::loadEvaluationResult(IStream& istrm) {
   auto json = JsonTrait::parse(istrm);
   if (JsonTrait::isObject(json)) {
-    lastEvalResult_ = make_shared<EvaluatedVariables>(json);
+    lastEvalResult_ = EvalResultStore::fromVar(Var{json});
+    keyedIn_ = nullptr;
+    return true;
+  }
+  return false;
+}
+
+bool HistoricalEvalContext::saveEvaluationResultBinary(std::ostream& ostrm) {
+  syncEvalResult();
+  if (auto res = lastEvalResult()) {
+    auto data = encodeVar(res->toVar());
+    ostrm.write(data.data(), static_cast<std::streamsize>(data.size()));
+    return true;
+  }
+  return false;
+}
+
+bool HistoricalEvalContext::loadEvaluationResultBinary(std::istream& istrm) {
+  auto data = make_shared<std::string>(std::istreambuf_iterator<char>{istrm},
+                                       std::istreambuf_iterator<char>{});
+  auto stored = lazyDecodeVar(*data, data);
+  if (stored.isDict()) {
+    lastEvalResult_ = EvalResultStore::fromVar(stored);
+    keyedIn_ = nullptr;
     return true;
   }
   return false;
@@ -377,6 +612,145 @@ std::vector<String> HistoricalEvalContext::supportedFunctions() const {
   return funcs;
 }
 
+EvalResultStore::ContextKey EvalResultStore::keyOf(const String& contextPath) {
+  auto [it, added] = keys_.emplace(contextPath, paths_.size());
+  if (added) {
+    paths_.push_back(contextPath);
+    variables_.emplace_back();
+    changed_.emplace_back();
+    if (auto unparsed = unparsed_.find(contextPath);
+        unparsed != std::end(unparsed_)) {
+      auto& variables = variables_.back();
+      for (auto& record : unparsed->second) {
+        auto parsed = Var(JsonTrait::parse(record));
+        for (auto& [variableName, value] : parsed.asDict()) {
+          variables[variableName] = value;
+        }
+      }
+      unparsed_.erase(unparsed);
+    }
+  }
+  return it->second;
+}
+
+const Var* EvalResultStore::get(ContextKey key,
+                                const StringView& variableName) const {
+  auto& variables = variables_[key];
+  auto it = variables.find(variableName);
+  return it != std::end(variables) ? &it->second : nullptr;
+}
+
+void EvalResultStore::put(ContextKey key, const String& variableName,
+                          Var value) {
+  auto [it, added] = variables_[key].try_emplace(variableName);
+  if (added || it->second != value) {
+    it->second = move(value);
+    changed_[key].insert(variableName);
+  }
+}
+
+Var EvalResultStore::toVar() {
+  loadAll();
+  auto stored = Var::dict();
+  for (size_t key = 0; key < paths_.size(); ++key) {
+    for (auto& [variableName, value] : variables_[key]) {
+      stored[strJoin(paths_[key], cstr::path_sep, variableName)] = value;
+    }
+  }
+  return stored;
+}
+
+std::shared_ptr<EvalResultStore> EvalResultStore::fromVar(const Var& stored) {
+  auto store = make_shared<EvalResultStore>();
+  for (auto& [path, value] : stored.asDict()) {
+    auto sep = path.rfind(cstr::path_sep);
+    if (sep != String::npos) {
+      store->put(store->keyOf(path.substr(0, sep)), path.substr(sep + 1),
+                 value);
+    }
+  }
+  return store;
+}
+
+bool EvalResultStore::appendLog(OStream& ostrm) {
+  for (size_t key = 0; key < paths_.size(); ++key) {
+    if (changed_[key].empty()) {
+      continue;
+    }
+    auto variables = Var::dict();
+    for (auto& variableName : changed_[key]) {
+      variables[variableName] = variables_[key].find(variableName)->second;
+    }
+    writeLogRecord(ostrm, paths_[key], variables);
+    changed_[key].clear();
+    ++loggedRecords_;
+  }
+  return ostrm.good();
+}
+
+bool EvalResultStore::writeLog(OStream& ostrm) {
+  loadAll();
+  loggedRecords_ = 0;
+  for (size_t key = 0; key < paths_.size(); ++key) {
+    if (variables_[key].empty()) {
+      continue;
+    }
+    auto variables = Var::dict();
+    for (auto& [variableName, value] : variables_[key]) {
+      variables[variableName] = value;
+    }
+    writeLogRecord(ostrm, paths_[key], variables);
+    changed_[key].clear();
+    ++loggedRecords_;
+  }
+  damaged_ = false;
+  return ostrm.good();
+}
+
+bool EvalResultStore::compactionDue() const {
+  constexpr size_t recordsPerContext = 4;
+  constexpr size_t minRecords = 64;
+  return damaged_ ||
+         loggedRecords_ >
+             std::max(minRecords,
+                      recordsPerContext * (paths_.size() + unparsed_.size()));
+}
+
+std::shared_ptr<EvalResultStore> EvalResultStore::fromLog(IStream& istrm) {
+  auto store = make_shared<EvalResultStore>();
+  String line;
+  EvalResultLogRecord record;
+  while (std::getline(istrm, line)) {
+    // a record without its line end was torn while being appended
+    if (istrm.eof() || !readLogRecord(line, record)) {
+      store->damaged_ = true;
+      break;
+    }
+    store->unparsed_[record.contextPath].push_back(move(record.variables));
+    ++store->loggedRecords_;
+  }
+  return store;
+}
+
+void EvalResultStore::loadAll() {
+  std::vector<String> paths;
+  paths.reserve(unparsed_.size());
+  for (auto& [path, records] : unparsed_) {
+    paths.push_back(path);
+  }
+  for (auto& path : paths) {
+    keyOf(path);
+  }
+}
+
+static size_t _toSnapshotAge(const Var& snapshot) {
+  __jas_func_throw_invalidargs_if(
+      !snapshot.isInt() || snapshot.getInt() > 0,
+      "Snapshot number must be 0 for current or -k for k snapshots back",
+      snapshot);
+  return static_cast<size_t>(-snapshot.getInt());
+}
+
 static HistoricalEvalContext::SnapshotIdx _toSnapshotIdx(
     const String& snapshot) {
   if (snapshot.empty()) {
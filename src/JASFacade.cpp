@@ -1,15 +1,18 @@
 #include "jas/JASFacade.h"
 
 #include "jas/BasicEvalContext.h"
+#include "jas/HistoricalEvalContext.h"
 #include "jas/ModuleManager.h"
 #include "jas/SyntaxEvaluator.h"
 #include "jas/SyntaxValidator.h"
 #include "jas/Translator.h"
+#include "jas/VarCodec.h"
 
 __module_creating_prototype(cif);
 __module_creating_prototype(list);
 __module_creating_prototype(dict);
 __module_creating_prototype(alg);
+__module_creating_prototype(set);
 
 namespace jas {
 
@@ -19,6 +22,7 @@ struct _JASFacade {
     addModule(mdl::list::getModule());
     addModule(mdl::dict::getModule());
     addModule(mdl::alg::getModule());
+    addModule(mdl::set::getModule());
   }
   _JASFacade(const Json &jasExpr, EvalContextPtr context) : _JASFacade() {
     this->context = move(context);
@@ -26,7 +30,12 @@ struct _JASFacade {
   }
 
   void setExpression(const Json &expr) {
-    evaluable = parser.translate(getContext(), expr);
+    Var rule = expr;
+    evaluable = parser.translate(getContext(), rule);
+    snapshotReads = parser.optimizations().reuseUnchangedResults
+                        ? parser.snapshotReads()
+                        : nullptr;
+    ruleDigest = snapshotReads ? digestVar(rule) : String{};
   }
 
   EvalContextPtr getContext() {
@@ -45,6 +54,8 @@ struct _JASFacade {
   Translator parser;
   EvaluablePtr evaluable;
   EvalContextPtr context;
+  std::shared_ptr<const SnapshotReads> snapshotReads;
+  String ruleDigest;
 };
 
 JASFacade::JASFacade() : d_(new _JASFacade) {}
@@ -69,6 +80,15 @@ Var JASFacade::evaluate() {
   if (!d_->context) {
     d_->context = std::make_shared<BasicEvalContext>();
   }
+  if (d_->snapshotReads) {
+    if (auto historical =
+            dynamic_cast<HistoricalEvalContext *>(d_->context.get())) {
+      return historical->reuseOrEvaluate(
+          d_->ruleDigest, *d_->snapshotReads, [this] {
+            return d_->evaluator.evaluate(d_->evaluable, d_->context);
+          });
+    }
+  }
   return d_->evaluator.evaluate(d_->evaluable, d_->context);
 }
 
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <numeric>
+
 #include "jas/EvaluableClasses.h"
 #include "jas/FunctionModuleBaseT.h"
 #include "jas/SyntaxEvaluatorImpl.h"
@@ -41,7 +44,8 @@ namespace alg {
     __alg_try_begin {                                                 \
       varlist.detach();                                               \
       auto& thelist = varlist.asList();                               \
-      auto& predicate = args.back();
+      auto& predicate = args.back();                                  \
+      EvaluationFramePtr itemFrame;
 
 #define __alg_list_predicate_func_end \
   }                                   \
@@ -59,8 +63,8 @@ __alg_list_predicate_func_begin(sort, tobesorted, predicate) {
   std::sort(std::begin(tobesorted), std::end(tobesorted),
             [&](const Var& first, const Var& second) {
               return evaluator
-                  ->evalAndReturn(predicate.get(), strJoin(++idx),
-                                  {first, second})
+                  ->evalAndReturnOnItem(itemFrame, predicate.get(),
+                                        strJoin(++idx), {first, second})
                   .asBool();
             });
   return tobesorted;
@@ -70,7 +74,8 @@ __alg_list_predicate_func_end;
 __alg_list_predicate_func_begin(filter, thelist, predicate) {
   auto filtered = Var::List{};
   for (auto& item : thelist) {
-    if (evaluator->evalAndReturn(predicate.get(), {}, {item}).asBool()) {
+    if (evaluator->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item})
+            .asBool()) {
       filtered.push_back(item);
     }
   }
@@ -83,7 +88,7 @@ __alg_list_predicate_func_begin(transform, thelist, predicate) {
   transformed.reserve(thelist.size());
   for (auto& item : thelist) {
     transformed.push_back(
-        evaluator->evalAndReturn(predicate.get(), {}, {item}));
+        evaluator->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item}));
   }
   return transformed;
 }
@@ -92,7 +97,9 @@ __alg_list_predicate_func_end;
 __alg_list_predicate_func_begin(any_of, thelist, predicate) {
   using namespace std;
   return any_of(begin(thelist), end(thelist), [&](auto& item) {
-    return evaluator->evalAndReturn(predicate.get(), {}, {item}).asBool();
+    return evaluator
+        ->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item})
+        .asBool();
   });
 }
 __alg_list_predicate_func_end;
@@ -100,7 +107,9 @@ __alg_list_predicate_func_end;
 __alg_list_predicate_func_begin(all_of, thelist, predicate) {
   using namespace std;
   return all_of(begin(thelist), end(thelist), [&](auto& item) {
-    return evaluator->evalAndReturn(predicate.get(), {}, {item}).asBool();
+    return evaluator
+        ->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item})
+        .asBool();
   });
 }
 __alg_list_predicate_func_end;
@@ -108,7 +117,9 @@ __alg_list_predicate_func_end;
 __alg_list_predicate_func_begin(none_of, thelist, predicate) {
   using namespace std;
   return std::none_of(begin(thelist), end(thelist), [&](auto& item) {
-    return evaluator->evalAndReturn(predicate.get(), {}, {item}).asBool();
+    return evaluator
+        ->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item})
+        .asBool();
   });
 }
 __alg_list_predicate_func_end;
@@ -116,7 +127,8 @@ __alg_list_predicate_func_end;
 __alg_list_predicate_func_begin(count_if, thelist, predicate) {
   size_t count = 0;
   for (auto& item : thelist) {
-    if (evaluator->evalAndReturn(predicate.get(), {}, {item}).asBool()) {
+    if (evaluator->evalAndReturnOnItem(itemFrame, predicate.get(), {}, {item})
+            .asBool()) {
       ++count;
     }
   }
@@ -124,6 +136,151 @@ __alg_list_predicate_func_begin(count_if, thelist, predicate) {
 }
 __alg_list_predicate_func_end;
 
+/// Keys of list items, each evaluated once then compared natively when they
+/// are all numbers or all strings
+class ItemKeys {
+ public:
+  ItemKeys(SyntaxEvaluatorImpl* evaluator, const Var::List& items,
+           const EvaluablePtr& key) {
+    keys_.reserve(items.size());
+    EvaluationFramePtr itemFrame;
+    int idx = 0;
+    bool numbers = true;
+    bool strings = true;
+    for (auto& item : items) {
+      keys_.push_back(evaluator->evalAndReturnOnItem(itemFrame, key.get(),
+                                                     strJoin(idx++), {item}));
+      numbers = numbers && keys_.back().isNumber();
+      strings = strings && keys_.back().isString();
+    }
+    if (numbers) {
+      numbers_.reserve(keys_.size());
+      for (auto& k : keys_) {
+        numbers_.push_back(k.asNumber());
+      }
+    } else if (strings) {
+      strings_.reserve(keys_.size());
+      for (auto& k : keys_) {
+        strings_.push_back(&k.asString());
+      }
+    }
+  }
+
+  size_t size() const { return keys_.size(); }
+
+  /// Invokes `visit` with the comparison of items by their indices
+  template <class _Visit>
+  decltype(auto) withLess(_Visit&& visit) const {
+    if (!numbers_.empty()) {
+      return visit(
+          [this](size_t a, size_t b) { return numbers_[a] < numbers_[b]; });
+    } else if (!strings_.empty()) {
+      return visit(
+          [this](size_t a, size_t b) { return *strings_[a] < *strings_[b]; });
+    } else {
+      return visit([this](size_t a, size_t b) { return keys_[a] < keys_[b]; });
+    }
+  }
+
+  std::vector<size_t> indices() const {
+    std::vector<size_t> indices(keys_.size());
+    std::iota(std::begin(indices), std::end(indices), 0);
+    return indices;
+  }
+
+ private:
+  Var::List keys_;
+  std::vector<Number> numbers_;
+  std::vector<const String*> strings_;
+};
+
+static Var::List _pick(const Var::List& items,
+                       const std::vector<size_t>& indices) {
+  Var::List picked;
+  picked.reserve(indices.size());
+  for (auto idx : indices) {
+    picked.push_back(items[idx]);
+  }
+  return picked;
+}
+
+__alg_list_predicate_func_begin(sort_by, tobesorted, key) {
+  ItemKeys keys{evaluator, tobesorted, key};
+  auto indices = keys.indices();
+  keys.withLess([&indices](auto less) {
+    std::sort(std::begin(indices), std::end(indices), less);
+  });
+  return _pick(tobesorted, indices);
+}
+__alg_list_predicate_func_end;
+
+__alg_list_predicate_func_begin(stable_sort_by, tobesorted, key) {
+  ItemKeys keys{evaluator, tobesorted, key};
+  auto indices = keys.indices();
+  keys.withLess([&indices](auto less) {
+    std::stable_sort(std::begin(indices), std::end(indices), less);
+  });
+  return _pick(tobesorted, indices);
+}
+__alg_list_predicate_func_end;
+
+/// First item of the least key if `greatest` is false, else of the greatest
+static Var _extremeBy(SyntaxEvaluatorImpl* evaluator, const Var::List& items,
+                      const EvaluablePtr& key, bool greatest) {
+  if (items.empty()) {
+    return {};
+  }
+  ItemKeys keys{evaluator, items, key};
+  auto extreme = keys.withLess([&keys, greatest](auto less) {
+    size_t found = 0;
+    for (size_t i = 1; i < keys.size(); ++i) {
+      if (greatest ? less(found, i) : less(i, found)) {
+        found = i;
+      }
+    }
+    return found;
+  });
+  return items[extreme];
+}
+
+__alg_list_predicate_func_begin(min_by, thelist, key) {
+  return _extremeBy(evaluator, thelist, key, false);
+}
+__alg_list_predicate_func_end;
+
+__alg_list_predicate_func_begin(max_by, thelist, key) {
+  return _extremeBy(evaluator, thelist, key, true);
+}
+__alg_list_predicate_func_end;
+
+/// [[list], key, k]: k items of greatest keys, in descending order of keys
+__alg_func(top_k) {
+  __alg_makesure_params_is_list(input);
+  auto& args = _2args(input);
+  __jas_ni_func_throw_invalidargs_if(args.size() != 3,
+                                     " parameters must be [[list], key, k]");
+  auto varlist = evaluator->evalAndReturn(args.front().get());
+  auto k = evaluator->evalAndReturn(args.back().get());
+  __jas_func_throw_invalidargs_if(!k.isInt() || k.asNumber() < Number{0},
+                                  " k must be a non-negative integer", k);
+  __alg_try_begin {
+    varlist.detach();
+    auto& thelist = varlist.asList();
+    auto count = std::min(k.getValue<size_t>(), thelist.size());
+    ItemKeys keys{evaluator, thelist, args[1]};
+    auto indices = keys.indices();
+    keys.withLess([&indices, count](auto less) {
+      std::partial_sort(
+          std::begin(indices), std::begin(indices) + count, std::end(indices),
+          [&less](size_t a, size_t b) { return less(b, a); });
+    });
+    indices.resize(count);
+    return _pick(thelist, indices);
+  }
+  __alg_try_end;
+  return {};
+}
+
 using AlgorithmFunc = Var (*)(EvaluablePtr param,
                               SyntaxEvaluatorImpl* evaluator);
 
@@ -132,14 +289,38 @@ class AlgorithmModule : public FunctionModuleBaseT<AlgorithmFunc> {
   String moduleName() const override { return JASSTR("alg"); }
   const FunctionsMap& _funcMap() const override {
     static FunctionsMap _ = {
-        __alg_mapping(sort),      __alg_mapping(filter),
-        __alg_mapping(transform), __alg_mapping(any_of),
-        __alg_mapping(all_of),    __alg_mapping(none_of),
-        __alg_mapping(count_if),
+        __alg_mapping(sort),           __alg_mapping(filter),
+        __alg_mapping(transform),      __alg_mapping(any_of),
+        __alg_mapping(all_of),         __alg_mapping(none_of),
+        __alg_mapping(count_if),       __alg_mapping(sort_by),
+        __alg_mapping(stable_sort_by), __alg_mapping(min_by),
+        __alg_mapping(max_by),         __alg_mapping(top_k),
     };
     return _;
   }
 
+  bool functionIsPure(const StringView& funcName) const override {
+    // algorithms work on a copy of the input list
+    return has(funcName);
+  }
+
+  StaticType functionReturnType(const StringView& funcName) const override {
+    static const std::map<StringView, StaticType, std::less<>> _ = {
+        {JASSTR("sort"), StaticType::list},
+        {JASSTR("filter"), StaticType::list},
+        {JASSTR("transform"), StaticType::list},
+        {JASSTR("any_of"), StaticType::boolean},
+        {JASSTR("all_of"), StaticType::boolean},
+        {JASSTR("none_of"), StaticType::boolean},
+        {JASSTR("count_if"), StaticType::number},
+        {JASSTR("sort_by"), StaticType::list},
+        {JASSTR("stable_sort_by"), StaticType::list},
+        {JASSTR("top_k"), StaticType::list},
+    };
+    auto it = _.find(funcName);
+    return it != std::end(_) ? it->second : StaticType::unknown;
+  }
+
   Var invoke(const AlgorithmFunc& func, EvaluablePtr param,
              SyntaxEvaluatorImpl* evaluator) override {
     return func(param, evaluator);
@@ -271,9 +271,9 @@ Var abs(const Var& data) {
   }
 }
 
-Var range(const Var& data) {
+bool range(const Var& data, const std::function<bool(const Number&)>& yield) {
   __jas_func_throw_invalidargs_if(
-      !data.isList() || data.size() > 3 || data.size() == 0,
+      !data.isList() || data.size() > 3 || data.size() < 2,
       "expect a list as [begin, end, (step)]", data);
   auto& options = data.asList();
   auto& vstart = options.front();
@@ -292,30 +292,32 @@ Var range(const Var& data) {
 
   __jas_func_throw_invalidargs_if(step == Number{0}, "Step must not be Zero",
                                   data);
-  Var::List range;
+  // the step counts from begin toward end whatever its sign
+  if (step < Number{0}) {
+    step = -step;
+  }
   if (start < end) {
-    if (step > Number{0}) {
-      do {
-        range.emplace_back(start);
-      } while ((start += step) < end);
-    } else {
-      range.emplace_back(start);
-      while (start < (end += step)) {
-        range.emplace_back(end);
+    do {
+      if (!yield(start)) {
+        return false;
       }
-    }
+    } while ((start += step) < end);
   } else {
-    if (step > Number{0}) {
-      do {
-        range.emplace_back(start);
-      } while ((start -= step) > end);
-    } else {
-      range.emplace_back(start);
-      while (start > (end -= step)) {
-        range.emplace_back(end);
+    do {
+      if (!yield(start)) {
+        return false;
       }
-    }
+    } while ((start -= step) > end);
   }
+  return true;
+}
+
+Var range(const Var& data) {
+  Var::List range;
+  cif::range(data, [&range](const Number& n) {
+    range.emplace_back(n);
+    return true;
+  });
   return range;
 }
 
@@ -351,11 +353,41 @@ class CIFModule : public FunctionModuleBaseT<JasUtilityFunction> {
         {JASSTR("empty"), empty},
         {JASSTR("not_empty"), not_empty},
         {JASSTR("abs"), abs},
-        {JASSTR("range"), range},
+        {JASSTR("range"), static_cast<Var (*)(const Var&)>(range)},
         {JASSTR("cdebug"), cdebug},
     };
     return _;
   }
+  bool functionIsPure(const StringView& funcName) const override {
+    return has(funcName) && funcName != JASSTR("current_time") &&
+           funcName != JASSTR("current_time_diff") &&
+           funcName != JASSTR("cdebug");
+  }
+  StaticType functionReturnType(const StringView& funcName) const override {
+    static const std::map<StringView, StaticType, std::less<>> _ = {
+        {JASSTR("current_time"), StaticType::number},
+        {JASSTR("current_time_diff"), StaticType::number},
+        {JASSTR("cmp_ver"), StaticType::number},
+        {JASSTR("eq_ver"), StaticType::boolean},
+        {JASSTR("ne_ver"), StaticType::boolean},
+        {JASSTR("lt_ver"), StaticType::boolean},
+        {JASSTR("gt_ver"), StaticType::boolean},
+        {JASSTR("ge_ver"), StaticType::boolean},
+        {JASSTR("le_ver"), StaticType::boolean},
+        {JASSTR("match_ver"), StaticType::boolean},
+        {JASSTR("contains"), StaticType::boolean},
+        {JASSTR("to_string"), StaticType::string},
+        {JASSTR("has_null_val"), StaticType::boolean},
+        {JASSTR("len"), StaticType::number},
+        {JASSTR("is_even"), StaticType::boolean},
+        {JASSTR("is_odd"), StaticType::boolean},
+        {JASSTR("empty"), StaticType::boolean},
+        {JASSTR("not_empty"), StaticType::boolean},
+        {JASSTR("range"), StaticType::list},
+    };
+    auto it = _.find(funcName);
+    return it != std::end(_) ? it->second : StaticType::unknown;
+  }
   Var invoke(const JasUtilityFunction& func, EvaluablePtr param,
              SyntaxEvaluatorImpl* evaluator) override {
     return func(evaluator->evalAndReturn(param.get()));
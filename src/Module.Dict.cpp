@@ -130,6 +130,20 @@ __dict_func(size, thedict) {
   return thedict.size();
 }
 
+__module_pure_funcs(dict, dict_func_keys, dict_func_values, dict_func_get,
+                    dict_func_get_path, dict_func_exists, dict_func_contains,
+                    dict_func_size, dict_func_is_empty);
+
+__module_return_types(dict, {dict_func_update, StaticType::dict},
+                      {dict_func_erase, StaticType::dict},
+                      {dict_func_contains, StaticType::boolean},
+                      {dict_func_exists, StaticType::boolean},
+                      {dict_func_clear, StaticType::dict},
+                      {dict_func_keys, StaticType::list},
+                      {dict_func_values, StaticType::list},
+                      {dict_func_is_empty, StaticType::boolean},
+                      {dict_func_size, StaticType::number});
+
 __module_class_begin(dict){
     __module_register_func(dict, update),
     __module_register_func(dict, erase),
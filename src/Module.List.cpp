@@ -145,6 +145,22 @@ __list_func(unique, input) {
   return input;
 }
 
+__module_pure_funcs(list, list_func_contains, list_func_count, list_func_len,
+                    list_func_size, list_func_is_empty);
+
+__module_return_types(list, {list_func_append, StaticType::list},
+                      {list_func_extend, StaticType::list},
+                      {list_func_remove, StaticType::boolean},
+                      {list_func_insert, StaticType::list},
+                      {list_func_clear, StaticType::list},
+                      {list_func_is_empty, StaticType::boolean},
+                      {list_func_contains, StaticType::boolean},
+                      {list_func_len, StaticType::number},
+                      {list_func_size, StaticType::number},
+                      {list_func_count, StaticType::number},
+                      {list_func_sort, StaticType::list},
+                      {list_func_unique, StaticType::list});
+
 __module_class_begin(list){
     __module_register_func(list, append),
     __module_register_func(list, contains),
@@ -0,0 +1,165 @@
+#include <algorithm>
+#include <unordered_set>
+
+#include "VarManipModuleShared.h"
+#include "jas/SyntaxEvaluatorImpl.h"
+
+namespace jas {
+namespace mdl {
+namespace set {
+
+#define __set_throw_if_not_list(thelist)                                     \
+  __jas_ni_func_throw_invalidargs_if(thelist.isNull(),                       \
+                                     "The list must not be null");           \
+  __jas_func_throw_invalidargs_if(!thelist.isList(), "expect a list", thelist)
+
+#define __set_check_lists(params, minCount)                                \
+  __set_throw_if_not_list(params);                                         \
+  __jas_ni_func_throw_invalidargs_if(params.size() < minCount,             \
+                                     "Missing param");                     \
+  for (auto &param : params.asList()) {                                    \
+    __set_throw_if_not_list(param);                                        \
+  }
+
+#define __set_func(name, params) __module_func(set, name, params)
+
+namespace {
+
+struct ItemHash {
+  size_t operator()(const Var *item) const { return item->hash(); }
+};
+
+struct ItemEqual {
+  bool operator()(const Var *first, const Var *second) const {
+    return *first == *second;
+  }
+};
+
+/// Items of a list, seen through pointers into the list
+using ItemSet = std::unordered_set<const Var *, ItemHash, ItemEqual>;
+
+/// Membership test on a list, hashing its items only when it is large enough
+/// for hashing to pay off
+class Membership {
+ public:
+  Membership(const Var::List &list) : list_(list) {
+    if (list.size() > linearScanLimit) {
+      items_.reserve(list.size());
+      for (auto &item : list) {
+        items_.insert(&item);
+      }
+    }
+  }
+
+  bool contains(const Var &item) const {
+    if (list_.size() > linearScanLimit) {
+      return items_.count(&item) != 0;
+    }
+    return std::find(std::begin(list_), std::end(list_), item) !=
+           std::end(list_);
+  }
+
+ private:
+  static constexpr size_t linearScanLimit = 8;
+  const Var::List &list_;
+  ItemSet items_;
+};
+
+std::vector<Membership> _membershipsOf(const Var::List &lists, size_t from) {
+  std::vector<Membership> memberships;
+  memberships.reserve(lists.size() - from);
+  for (auto it = std::begin(lists) + from; it != std::end(lists); ++it) {
+    memberships.emplace_back(it->asList());
+  }
+  return memberships;
+}
+
+/// Adds items of `list` that are not seen yet and `keep` accepts, in order
+template <class _Keep>
+void _addDistinct(const Var::List &list, ItemSet &seen, Var::List &out,
+                  _Keep &&keep) {
+  for (auto &item : list) {
+    if (keep(item) && seen.insert(&item).second) {
+      out.push_back(item);
+    }
+  }
+}
+
+}  // namespace
+
+__set_func(distinct, thelist) {
+  __set_throw_if_not_list(thelist);
+  auto &items = thelist.asList();
+  ItemSet seen;
+  seen.reserve(items.size());
+  Var::List out;
+  _addDistinct(items, seen, out, [](auto &) { return true; });
+  return out;
+}
+
+__set_func(union, params) {
+  __set_check_lists(params, 1);
+  ItemSet seen;
+  Var::List out;
+  for (auto &param : params.asList()) {
+    _addDistinct(param.asList(), seen, out, [](auto &) { return true; });
+  }
+  return out;
+}
+
+__set_func(intersect, params) {
+  __set_check_lists(params, 2);
+  auto &lists = params.asList();
+  auto others = _membershipsOf(lists, 1);
+  ItemSet seen;
+  Var::List out;
+  _addDistinct(lists.front().asList(), seen, out, [&others](auto &item) {
+    return std::all_of(std::begin(others), std::end(others),
+                       [&item](auto &other) { return other.contains(item); });
+  });
+  return out;
+}
+
+__set_func(difference, params) {
+  __set_check_lists(params, 2);
+  auto &lists = params.asList();
+  auto others = _membershipsOf(lists, 1);
+  ItemSet seen;
+  Var::List out;
+  _addDistinct(lists.front().asList(), seen, out, [&others](auto &item) {
+    return std::none_of(std::begin(others), std::end(others),
+                        [&item](auto &other) { return other.contains(item); });
+  });
+  return out;
+}
+
+__set_func(is_subset, params) {
+  __set_check_lists(params, 2);
+  __jas_ni_func_throw_invalidargs_if(params.size() != 2,
+                                     "parameters must be [subset, superset]");
+  auto &subset = params[0].asList();
+  Membership superset{params[1].asList()};
+  return std::all_of(std::begin(subset), std::end(subset),
+                     [&superset](auto &item) { return superset.contains(item); });
+}
+
+__module_pure_funcs(set, set_func_distinct, set_func_union, set_func_intersect,
+                    set_func_difference, set_func_is_subset);
+
+__module_return_types(set, {set_func_distinct, StaticType::list},
+                      {set_func_union, StaticType::list},
+                      {set_func_intersect, StaticType::list},
+                      {set_func_difference, StaticType::list},
+                      {set_func_is_subset, StaticType::boolean});
+
+__module_class_begin(set){
+    __module_register_func(set, distinct),
+    __module_register_func(set, union),
+    __module_register_func(set, intersect),
+    __module_register_func(set, difference),
+    __module_register_func(set, is_subset),
+} __module_class_end(set)
+
+}  // namespace set
+}  // namespace mdl
+}  // namespace jas
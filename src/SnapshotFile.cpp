@@ -0,0 +1,72 @@
+#include "jas/SnapshotFile.h"
+
+#include <fstream>
+#include <iterator>
+
+#if !defined(JAS_USE_WSTR) && (defined(__unix__) || defined(__APPLE__))
+#define JAS_MAP_SNAPSHOT_FILES 1
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace jas {
+
+std::shared_ptr<const SnapshotFile> SnapshotFile::open(
+    const std::filesystem::path& path) {
+  std::shared_ptr<SnapshotFile> file{new SnapshotFile};
+#ifdef JAS_MAP_SNAPSHOT_FILES
+  auto fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    return nullptr;
+  }
+  struct stat status;
+  auto statted = ::fstat(fd, &status) == 0;
+  if (statted && status.st_size > 0) {
+    auto mapped = ::mmap(nullptr, static_cast<size_t>(status.st_size),
+                         PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped != MAP_FAILED) {
+      file->mapped_ = mapped;
+      file->mappedSize_ = static_cast<size_t>(status.st_size);
+    }
+  }
+  ::close(fd);
+  if (statted && (file->mapped_ || status.st_size == 0)) {
+    return file;
+  }
+#endif
+  // read whole where files are not mapped or could not be
+  std::basic_ifstream<CharType> ifs{path, std::ios_base::binary};
+  if (!ifs.is_open()) {
+    return nullptr;
+  }
+  file->read_.assign(std::istreambuf_iterator<CharType>{ifs},
+                     std::istreambuf_iterator<CharType>{});
+  return file;
+}
+
+SnapshotFile::~SnapshotFile() {
+#ifdef JAS_MAP_SNAPSHOT_FILES
+  if (mapped_) {
+    ::munmap(mapped_, mappedSize_);
+  }
+#endif
+}
+
+StringView SnapshotFile::text() const {
+  if (mapped_) {
+    return StringView{static_cast<const CharType*>(mapped_), mappedSize_};
+  }
+  return read_;
+}
+
+void SnapshotFile::dropPages() const {
+#ifdef JAS_MAP_SNAPSHOT_FILES
+  if (mapped_) {
+    ::madvise(mapped_, mappedSize_, MADV_DONTNEED);
+  }
+#endif
+}
+
+}  // namespace jas
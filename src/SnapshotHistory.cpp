@@ -0,0 +1,69 @@
+#include "jas/SnapshotHistory.h"
+
+#include <algorithm>
+
+namespace jas {
+
+namespace {
+
+/// `current` with its subtrees equal to those of `last` replaced by them.
+/// Containers on changed paths are rebuilt, the inputs are not modified
+Var _shareWith(const Var& current, const Var& last) {
+  if (current.hash() == last.hash() && current == last) {
+    return last;
+  }
+  if (current.isDict() && last.isDict()) {
+    auto& lastDict = last.asDict();
+    Var::Dict shared;
+    for (auto& [key, value] : current.asDict()) {
+      auto it = lastDict.find(key);
+      shared.emplace_hint(std::end(shared), key,
+                          it != std::end(lastDict)
+                              ? _shareWith(value, it->second)
+                              : value);
+    }
+    return shared;
+  }
+  if (current.isList() && last.isList()) {
+    auto& currentList = current.asList();
+    auto& lastList = last.asList();
+    Var::List shared;
+    shared.reserve(currentList.size());
+    for (size_t i = 0; i < currentList.size(); ++i) {
+      shared.push_back(i < lastList.size()
+                           ? _shareWith(currentList[i], lastList[i])
+                           : currentList[i]);
+    }
+    return shared;
+  }
+  return current;
+}
+
+}  // namespace
+
+SnapshotHistory::SnapshotHistory(size_t capacity)
+    : capacity_(std::max<size_t>(capacity, 1)) {}
+
+void SnapshotHistory::push(Var snapshot) {
+  if (snapshot.isRef()) {
+    snapshot = *snapshot.asRef();
+  }
+  if (!snapshots_.empty()) {
+    snapshot = _shareWith(snapshot, snapshots_.front());
+  }
+  snapshots_.push_front(std::move(snapshot));
+  if (snapshots_.size() > capacity_) {
+    snapshots_.pop_back();
+  }
+}
+
+const Var& SnapshotHistory::at(size_t age) const {
+  static const Var notHeld;
+  return age < snapshots_.size() ? snapshots_[age] : notHeld;
+}
+
+size_t SnapshotHistory::size() const { return snapshots_.size(); }
+
+size_t SnapshotHistory::capacity() const { return capacity_; }
+
+}  // namespace jas
@@ -0,0 +1,499 @@
+#include "jas/SnapshotParser.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+
+namespace jas {
+
+namespace {
+
+bool _isSpace(CharType c) {
+  return c == JASSTR(' ') || c == JASSTR('\n') || c == JASSTR('\r') ||
+         c == JASSTR('\t');
+}
+
+bool _isDigit(CharType c) { return c >= JASSTR('0') && c <= JASSTR('9'); }
+
+/// Index of list items that a path segment selects, the same way as
+/// Var::getPath does
+bool _toIndex(const String& segment, size_t& index) {
+  if (segment.empty() || segment.size() > 18) {
+    return false;
+  }
+  index = 0;
+  for (auto c : segment) {
+    if (!_isDigit(c)) {
+      return false;
+    }
+    index = index * 10 + static_cast<size_t>(c - JASSTR('0'));
+  }
+  return true;
+}
+
+void _appendCodePoint(String& out, uint32_t code) {
+  if constexpr (sizeof(CharType) == 1) {
+    if (code < 0x80) {
+      out += static_cast<CharType>(code);
+    } else if (code < 0x800) {
+      out += static_cast<CharType>(0xc0 | (code >> 6));
+      out += static_cast<CharType>(0x80 | (code & 0x3f));
+    } else if (code < 0x10000) {
+      out += static_cast<CharType>(0xe0 | (code >> 12));
+      out += static_cast<CharType>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<CharType>(0x80 | (code & 0x3f));
+    } else {
+      out += static_cast<CharType>(0xf0 | (code >> 18));
+      out += static_cast<CharType>(0x80 | ((code >> 12) & 0x3f));
+      out += static_cast<CharType>(0x80 | ((code >> 6) & 0x3f));
+      out += static_cast<CharType>(0x80 | (code & 0x3f));
+    }
+  } else if constexpr (sizeof(CharType) == 2) {
+    if (code < 0x10000) {
+      out += static_cast<CharType>(code);
+    } else {
+      code -= 0x10000;
+      out += static_cast<CharType>(0xd800 + (code >> 10));
+      out += static_cast<CharType>(0xdc00 + (code & 0x3ff));
+    }
+  } else {
+    out += static_cast<CharType>(code);
+  }
+}
+
+template <class T>
+bool _toNumber(const std::string& text, T& out) {
+  auto end = text.data() + text.size();
+  auto result = std::from_chars(text.data(), end, out);
+  return result.ec == std::errc{} && result.ptr == end;
+}
+
+}  // namespace
+
+class SnapshotParser {
+ public:
+  /// Dicts and lists in `text` are decoded when first accessed if it is held
+  /// by `holder`
+  SnapshotParser(const StringView& text, const SnapshotProjection& projection,
+                 std::shared_ptr<const void> holder = {})
+      : text_(text), nodes_(projection.nodes_), holder_(std::move(holder)) {}
+
+  Var parse() {
+    Var value;
+    if (!parseValue(keeping(0), value)) {
+      return {};
+    }
+    skipSpaces();
+    return pos_ == text_.size() ? value : Var{};
+  }
+
+ private:
+  static constexpr size_t all = static_cast<size_t>(-1);
+
+  size_t keeping(size_t node) const {
+    return nodes_[node].keepsAll ? all : node;
+  }
+
+  bool parseValue(size_t node, Var& value) {
+    skipSpaces();
+    if (pos_ >= text_.size()) {
+      return false;
+    }
+    switch (text_[pos_]) {
+      case JASSTR('{'):
+        return parseDict(node, value);
+      case JASSTR('['):
+        return parseList(node, value);
+      case JASSTR('"'): {
+        String str;
+        if (!parseString(str)) {
+          return false;
+        }
+        value = Var(std::move(str));
+        return true;
+      }
+      case JASSTR('t'):
+        value = Var(true);
+        return parseLiteral(JASSTR("true"));
+      case JASSTR('f'):
+        value = Var(false);
+        return parseLiteral(JASSTR("false"));
+      case JASSTR('n'):
+        value = Var{};
+        return parseLiteral(JASSTR("null"));
+      default:
+        return parseNumber(value);
+    }
+  }
+
+  bool parseChild(size_t node, Var& value) {
+    skipSpaces();
+    if (!holder_ || pos_ >= text_.size() ||
+        (text_[pos_] != JASSTR('{') && text_[pos_] != JASSTR('['))) {
+      return parseValue(node, value);
+    }
+    auto begin = pos_;
+    if (!skipValue()) {
+      return false;
+    }
+    value = lazySnapshot(text_.substr(begin, pos_ - begin), holder_);
+    return true;
+  }
+
+  bool parseDict(size_t node, Var& value) {
+    ++pos_;
+    Var::Dict dict;
+    skipSpaces();
+    if (!consume(JASSTR('}'))) {
+      do {
+        skipSpaces();
+        String key;
+        if (!parseString(key)) {
+          return false;
+        }
+        skipSpaces();
+        if (!consume(JASSTR(':'))) {
+          return false;
+        }
+        auto child = all;
+        if (node != all) {
+          auto& children = nodes_[node].children;
+          auto it = children.find(key);
+          if (it == std::end(children)) {
+            if (!skipValue()) {
+              return false;
+            }
+            skipSpaces();
+            continue;
+          }
+          child = keeping(it->second);
+        }
+        Var item;
+        if (!parseChild(child, item)) {
+          return false;
+        }
+        // the last of duplicated keys is kept
+        dict.insert_or_assign(std::move(key), std::move(item));
+        skipSpaces();
+      } while (consume(JASSTR(',')));
+      if (!consume(JASSTR('}'))) {
+        return false;
+      }
+    }
+    value = Var(std::move(dict));
+    return true;
+  }
+
+  bool parseList(size_t node, Var& value) {
+    ++pos_;
+    // projected items by their indices
+    std::vector<std::pair<size_t, size_t>> projected;
+    if (node != all) {
+      for (auto& [segment, child] : nodes_[node].children) {
+        size_t index = 0;
+        if (_toIndex(segment, index)) {
+          projected.emplace_back(index, keeping(child));
+        }
+      }
+      std::sort(std::begin(projected), std::end(projected));
+    }
+    auto next = std::begin(projected);
+    Var::List list;
+    skipSpaces();
+    if (!consume(JASSTR(']'))) {
+      do {
+        auto index = list.size();
+        while (next != std::end(projected) && next->first < index) {
+          ++next;
+        }
+        auto& item = list.emplace_back();
+        if (node == all) {
+          if (!parseChild(all, item)) {
+            return false;
+          }
+        } else if (next != std::end(projected) && next->first == index) {
+          if (!parseValue(next->second, item)) {
+            return false;
+          }
+        } else if (!skipValue()) {
+          return false;
+        }
+        skipSpaces();
+      } while (consume(JASSTR(',')));
+      if (!consume(JASSTR(']'))) {
+        return false;
+      }
+    }
+    value = Var(std::move(list));
+    return true;
+  }
+
+  bool parseString(String& out) {
+    if (!consume(JASSTR('"'))) {
+      return false;
+    }
+    while (true) {
+      auto end = text_.find_first_of(JASSTR("\"\\"), pos_);
+      if (end == StringView::npos) {
+        return false;
+      }
+      out.append(text_.data() + pos_, end - pos_);
+      pos_ = end + 1;
+      if (text_[end] == JASSTR('"')) {
+        return true;
+      }
+      if (pos_ >= text_.size()) {
+        return false;
+      }
+      switch (auto c = text_[pos_++]) {
+        case JASSTR('"'):
+        case JASSTR('\\'):
+        case JASSTR('/'):
+          out += c;
+          break;
+        case JASSTR('b'):
+          out += JASSTR('\b');
+          break;
+        case JASSTR('f'):
+          out += JASSTR('\f');
+          break;
+        case JASSTR('n'):
+          out += JASSTR('\n');
+          break;
+        case JASSTR('r'):
+          out += JASSTR('\r');
+          break;
+        case JASSTR('t'):
+          out += JASSTR('\t');
+          break;
+        case JASSTR('u'):
+          if (!parseUnicode(out)) {
+            return false;
+          }
+          break;
+        default:
+          return false;
+      }
+    }
+  }
+
+  bool parseUnicode(String& out) {
+    uint32_t code = 0;
+    if (!parseHex(code)) {
+      return false;
+    }
+    // a high surrogate followed by a low one is a single code point
+    if (code >= 0xd800 && code < 0xdc00 &&
+        text_.substr(pos_, 2) == JASSTR("\\u")) {
+      auto mark = pos_;
+      pos_ += 2;
+      uint32_t low = 0;
+      if (parseHex(low) && low >= 0xdc00 && low < 0xe000) {
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+      } else {
+        pos_ = mark;
+      }
+    }
+    _appendCodePoint(out, code);
+    return true;
+  }
+
+  bool parseHex(uint32_t& code) {
+    if (text_.size() - pos_ < 4) {
+      return false;
+    }
+    for (auto end = pos_ + 4; pos_ < end; ++pos_) {
+      auto c = text_[pos_];
+      code <<= 4;
+      if (_isDigit(c)) {
+        code |= static_cast<uint32_t>(c - JASSTR('0'));
+      } else if (c >= JASSTR('a') && c <= JASSTR('f')) {
+        code |= static_cast<uint32_t>(c - JASSTR('a') + 10);
+      } else if (c >= JASSTR('A') && c <= JASSTR('F')) {
+        code |= static_cast<uint32_t>(c - JASSTR('A') + 10);
+      } else {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool parseNumber(Var& value) {
+    std::string number;
+    auto integral = true;
+    for (; pos_ < text_.size(); ++pos_) {
+      auto c = text_[pos_];
+      if (_isDigit(c) || c == JASSTR('-')) {
+        number += static_cast<char>(c);
+      } else if (c == JASSTR('.') || c == JASSTR('e') || c == JASSTR('E') ||
+                 c == JASSTR('+')) {
+        number += static_cast<char>(c);
+        integral = false;
+      } else {
+        break;
+      }
+    }
+    if (integral) {
+      Var::Int i = 0;
+      if (_toNumber(number, i)) {
+        value = Var(i);
+        return true;
+      }
+    }
+    // integers out of range are kept as doubles
+    Var::Double d = 0;
+    if (!_toNumber(number, d)) {
+      return false;
+    }
+    value = Var(d);
+    return true;
+  }
+
+  bool parseLiteral(const StringView& literal) {
+    if (text_.compare(pos_, literal.size(), literal) != 0) {
+      return false;
+    }
+    pos_ += literal.size();
+    return true;
+  }
+
+  bool skipValue() {
+    skipSpaces();
+    if (pos_ >= text_.size()) {
+      return false;
+    }
+    auto c = text_[pos_];
+    if (c == JASSTR('"')) {
+      return skipString();
+    } else if (c != JASSTR('{') && c != JASSTR('[')) {
+      auto begin = pos_;
+      while (pos_ < text_.size() && !_isSpace(text_[pos_]) &&
+             text_[pos_] != JASSTR(',') && text_[pos_] != JASSTR('}') &&
+             text_[pos_] != JASSTR(']')) {
+        ++pos_;
+      }
+      return pos_ > begin;
+    }
+    String closers;
+    do {
+      c = text_[pos_];
+      if (c == JASSTR('"')) {
+        if (!skipString()) {
+          return false;
+        }
+        continue;
+      } else if (c == JASSTR('{')) {
+        closers += JASSTR('}');
+      } else if (c == JASSTR('[')) {
+        closers += JASSTR(']');
+      } else if (c == JASSTR('}') || c == JASSTR(']')) {
+        if (closers.back() != c) {
+          return false;
+        }
+        closers.pop_back();
+      }
+      ++pos_;
+    } while (!closers.empty() && pos_ < text_.size());
+    return closers.empty();
+  }
+
+  bool skipString() {
+    for (++pos_; pos_ < text_.size(); ++pos_) {
+      if (text_[pos_] == JASSTR('\\')) {
+        ++pos_;
+      } else if (text_[pos_] == JASSTR('"')) {
+        ++pos_;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  void skipSpaces() {
+    while (pos_ < text_.size() && _isSpace(text_[pos_])) {
+      ++pos_;
+    }
+  }
+
+  bool consume(CharType c) {
+    if (pos_ < text_.size() && text_[pos_] == c) {
+      ++pos_;
+      return true;
+    }
+    return false;
+  }
+
+  StringView text_;
+  const std::vector<SnapshotProjection::Node>& nodes_;
+  std::shared_ptr<const void> holder_;
+  size_t pos_ = 0;
+};
+
+namespace {
+
+/// Json text of a node, held by `holder`
+class JsonTextSource : public Var::Source {
+ public:
+  JsonTextSource(const StringView& text, std::shared_ptr<const void> holder)
+      : text_(text), holder_(std::move(holder)) {}
+
+  Var convert() const override {
+    static const SnapshotProjection whole;
+    return SnapshotParser{text_, whole, holder_}.parse();
+  }
+
+ private:
+  StringView text_;
+  std::shared_ptr<const void> holder_;
+};
+
+}  // namespace
+
+SnapshotProjection::SnapshotProjection() : nodes_(1) {
+  nodes_.front().keepsAll = true;
+}
+
+SnapshotProjection::SnapshotProjection(const std::set<String>& paths)
+    : nodes_(1) {
+  for (auto& path : paths) {
+    size_t node = 0;
+    for (auto& segment : PathView{path}) {
+      // an empty path has a single empty segment
+      if (segment.empty() || nodes_[node].keepsAll) {
+        break;
+      }
+      auto& children = nodes_[node].children;
+      auto it = children.find(segment);
+      if (it != std::end(children)) {
+        node = it->second;
+      } else {
+        auto child = nodes_.size();
+        children.emplace(String{segment}, child);
+        nodes_.emplace_back();
+        node = child;
+      }
+    }
+    nodes_[node].keepsAll = true;
+  }
+}
+
+bool SnapshotProjection::keepsAll() const { return nodes_.front().keepsAll; }
+
+Var parseSnapshot(const StringView& text,
+                  const SnapshotProjection& projection) {
+  return SnapshotParser{text, projection}.parse();
+}
+
+Var lazySnapshot(const StringView& text, std::shared_ptr<const void> holder) {
+  return Var::lazy(std::make_shared<JsonTextSource>(text, std::move(holder)));
+}
+
+Var lazySnapshot(std::shared_ptr<const SnapshotFile> file) {
+  if (!file) {
+    return {};
+  }
+  auto text = file->text();
+  return lazySnapshot(text, std::move(file));
+}
+
+}  // namespace jas
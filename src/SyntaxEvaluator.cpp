@@ -1,19 +1,42 @@
 #include "jas/SyntaxEvaluator.h"
 
+#include <typeindex>
+
+#include "details/ClosureCompiler.h"
 #include "jas/SyntaxEvaluatorImpl.h"
 
 namespace jas {
 
+/// Purity of context functions, on which closures depend, is told by the type
+/// of the root context
+static std::type_index contextTypeOf(const EvalContextPtr& context) {
+  if (!context) {
+    return typeid(void);
+  }
+  auto& rootContext = *context;
+  return typeid(rootContext);
+}
+
 SyntaxEvaluator::SyntaxEvaluator() : impl_{new SyntaxEvaluatorImpl} {}
 
 SyntaxEvaluator::~SyntaxEvaluator() { delete impl_; }
 
 Var SyntaxEvaluator::evaluate(const Evaluable& e, EvalContextPtr rootContext) {
+  // closures are compiled for shared evaluables only, to be reused
+  impl_->compiled_ = nullptr;
   return impl_->evaluate(e, move(rootContext));
 }
 
 Var SyntaxEvaluator::evaluate(const EvaluablePtr& e,
                               EvalContextPtr rootContext) {
+  impl_->compiled_ = nullptr;
+  if (engine_ == Engine::Closures && e && !impl_->dbCallback_) {
+    if (!program_ || program_->root != e ||
+        program_->contextType != contextTypeOf(rootContext)) {
+      program_ = compileClosures(e, rootContext);
+    }
+    impl_->compiled_ = program_.get();
+  }
   return impl_->evaluate(e, move(rootContext));
 }
 void SyntaxEvaluator::setDebugInfoCallback(
@@ -21,4 +44,11 @@ void SyntaxEvaluator::setDebugInfoCallback(
   impl_->setDebugInfoCallback(move(debugOutputCallback));
 }
 
+void SyntaxEvaluator::setEngine(Engine engine) {
+  engine_ = engine;
+  program_.reset();
+}
+
+SyntaxEvaluator::Engine SyntaxEvaluator::engine() const { return engine_; }
+
 }  // namespace jas
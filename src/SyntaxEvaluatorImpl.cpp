@@ -1,16 +1,23 @@
 #include "jas/SyntaxEvaluatorImpl.h"
 
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <iomanip>
+#include <iterator>
 #include <memory>
 #include <numeric>
 #include <sstream>
+#include <utility>
 
+#include "details/CompiledNode.h"
 #include "details/EvaluationStack.h"
+#include "details/FieldPredicate.h"
+#include "details/ValueComparison.h"
 #include "jas/EvaluableClasses.h"
 #include "jas/Exception.h"
 #include "jas/Keywords.h"
+#include "jas/Module.CIF.h"
 #include "jas/ModuleManager.h"
 #include "jas/OpTraits.h"
 #include "jas/String.h"
@@ -24,51 +31,138 @@ namespace jas {
 using std::make_shared;
 using std::move;
 using Vars = std::vector<Var>;
-struct EvaluatedOnReadValue;
-using EvaluatedOnReadValues = std::vector<EvaluatedOnReadValue>;
-
-struct EvaluatedOnReadValue {
-  EvaluatedOnReadValue(SyntaxEvaluatorImpl* delegate, const Evaluable& e)
-      : delegate_(delegate), e_(e) {}
+struct OperandsRelease {
+  ~OperandsRelease() {
+    pools.release();
+    arena.release();
+  }
+  std::pmr::unsynchronized_pool_resource& pools;
+  std::pmr::monotonic_buffer_resource& arena;
+};
 
-  operator Var() const {
-    if (ed_.isNull()) {
-      ed_ = delegate_->evalAndReturn(&e_);
-    }
-    return ed_;
+/// Typed paths for operators of which operand types are proven by
+/// translate-time type inference, operands are read as values of the proven
+/// type without being checked
+template <template <class> class _std_op>
+Var foldNumbers(const EvaluatedOnReadValues& evals) {
+  _std_op<Number> applier;
+  auto it = std::begin(evals);
+  auto v = it->value().asNumber();
+  while (++it != std::end(evals)) {
+    v = applier(v, it->value().asNumber());
   }
+  return v;
+}
 
-  SyntaxEvaluatorImpl* delegate_;
-  const Evaluable& e_;
-  mutable Var ed_;
-};
+template <template <class> class _std_op>
+Var applyNumber(const EvaluatedOnReadValues& evals) {
+  return _std_op<Number>{}(evals.back().value().asNumber());
+}
 
-template <class _Exception>
-struct StackUnwin : public _Exception {
-  using _Base = _Exception;
-  using _Base::_Base;
-};
+Var concatenateStrings(const EvaluatedOnReadValues& evals) {
+  size_t size = 0;
+  for (auto& e : evals) {
+    size += e.value().asString().size();
+  }
+  String concatenated;
+  concatenated.reserve(size);
+  for (auto& e : evals) {
+    concatenated += e.value().asString();
+  }
+  return concatenated;
+}
 
-template <class _Callable>
-Var filter_if(const Vars& list, _Callable&& cond) {
-  auto filtered = Var::list();
-  for (auto& item : list) {
-    if (cond(item)) {
-      filtered.add(item);
+/// `@plus` on strings, lists or dicts, building the result once instead of
+/// copying the growing sum for each operand. Returns false if operands are
+/// not all of one of those types
+bool concatenate(const EvaluatedOnReadValues& evals, Var& result) {
+  Var first = evals.front();
+  if (!first.isString() && !first.isList() && !first.isDict()) {
+    return false;
+  }
+  size_t size = 0;
+  for (auto& e : evals) {
+    Var next = e;
+    if (first.isString() ? !next.isString()
+                         : first.isList() ? !next.isList() : !next.isDict()) {
+      return false;
     }
+    size += first.isString() ? next.asString().size() : next.size();
   }
-  return filtered;
+  if (first.isString()) {
+    String concatenated;
+    concatenated.reserve(size);
+    for (auto& e : evals) {
+      concatenated += Var{e}.asString();
+    }
+    result = move(concatenated);
+  } else if (first.isList()) {
+    Var::List concatenated;
+    concatenated.reserve(size);
+    for (auto& e : evals) {
+      const Var next = e;
+      auto& items = next.asList();
+      concatenated.insert(std::end(concatenated), std::begin(items),
+                          std::end(items));
+    }
+    result = move(concatenated);
+  } else {
+    Var::Dict merged;
+    for (auto& e : evals) {
+      const Var next = e;
+      auto& items = next.asDict();
+      merged.insert(std::begin(items), std::end(items));
+    }
+    result = move(merged);
+  }
+  return true;
 }
 
-template <class _Callable>
-Var transform(const Vars& list, _Callable&& transf) {
-  auto transformed = Var::list();
-  for (auto& item : list) {
-    transformed.add(transf(item));
+/// `@and` stops at the first false operand, `@or` at the first true one
+template <bool _untilVal>
+Var foldBools(const EvaluatedOnReadValues& evals) {
+  for (auto& e : evals) {
+    if (e.value().asBool() == _untilVal) {
+      return _untilVal;
+    }
   }
-  return transformed;
+  return !_untilVal;
 }
 
+Var negateBool(const EvaluatedOnReadValues& evals) {
+  return !evals.back().value().asBool();
+}
+
+template <class T>
+const T& typedValue(const Var& v);
+template <>
+const Number& typedValue<Number>(const Var& v) {
+  return v.asNumber();
+}
+template <>
+const String& typedValue<String>(const Var& v) {
+  return v.asString();
+}
+
+template <cot _type, class T>
+Var compareTyped(SyntaxEvaluatorImpl&, const Evaluable&,
+                 const EvaluatedOnReadValues& evals) {
+  auto& first = typedValue<T>(evals.front().value());
+  return compareValues(_type, first, typedValue<T>(evals.back().value()));
+}
+
+template <Var (*_apply)(const EvaluatedOnReadValues&)>
+Var applyTyped(SyntaxEvaluatorImpl&, const Evaluable&,
+               const EvaluatedOnReadValues& evals) {
+  return _apply(evals);
+}
+
+template <class _Exception>
+struct StackUnwin : public _Exception {
+  using _Base = _Exception;
+  using _Base::_Base;
+};
+
 inline auto operator+(const Var::List& lhs, const Var::List& rhs) {
   auto out = lhs;
   out.insert(std::end(out), std::begin(rhs), std::end(rhs));
@@ -81,6 +175,36 @@ inline auto operator+(const Var::Dict& lhs, const Var::Dict& rhs) {
   return out;
 }
 
+/// `lhs += rhs` on strings, lists and dicts, appending to `lhs` instead of
+/// building the sum aside. Returns false if operands are of other types
+static bool _plusInPlace(Var& lhs, const Var& rhs) {
+  if (lhs.isString() && rhs.isString()) {
+    auto& added = rhs.asString();
+    if (&added == &lhs.asString()) {
+      lhs.asString() += String{added};
+    } else {
+      lhs.asString() += added;
+    }
+  } else if (lhs.isList() && rhs.isList()) {
+    auto& added = rhs.asList();
+    auto& list = lhs.asList();
+    if (&added == &list) {
+      list.reserve(list.size() * 2);
+      std::copy_n(std::begin(list), list.size(), std::back_inserter(list));
+    } else {
+      list.insert(std::end(list), std::begin(added), std::end(added));
+    }
+  } else if (lhs.isDict() && rhs.isDict()) {
+    auto& added = rhs.asDict();
+    if (&added != &lhs.asDict()) {
+      lhs.asDict().insert(std::begin(added), std::end(added));
+    }
+  } else {
+    return false;
+  }
+  return true;
+}
+
 #define __MC_STACK_START(ctxtID, evb, ...)  \
   stack_->push(ctxtID, evb, ##__VA_ARGS__); \
   try {
@@ -144,7 +268,15 @@ Var SyntaxEvaluatorImpl::evaluate(const Evaluable& e,
   if (validator.validate(e)) {
     // push root context to stack as main entry
     stack_->init(move(rootContext), &e);
-    e.accept(this);
+    pendingVariables_ = 0;
+    OperandsRelease releaseOperands{operandPools_, operandsArena_};
+    if (compiled_) {
+      auto& entry = compiled_->entry;
+      stack_->top()->compiled = &entry;
+      stack_->return_(entry.invoke(entry, *this));
+    } else {
+      e.accept(this);
+    }
     evaluated = stackTakeReturnedVal();
   } else {
     __jas_throw(SyntaxError, validator.getReport());
@@ -207,60 +339,234 @@ void SyntaxEvaluatorImpl::eval(const ArithmaticalOperator& op) {
   }
 
   evaluateLocalSymbols(op);
-  auto e = evaluateOperator(op, [&op, this](auto&& evaluatedVals) {
-    __MC_BASIC_OPERATION_EVAL_START(op)
-    switch (op.type) {
-      case aot::bit_and:
-        return applyMultiBinOp<aot, aot::bit_and, std::bit_and>(evaluatedVals);
-      case aot::bit_not:
-        return applyUnaryOp<aot, aot::bit_not, std::bit_not>(evaluatedVals);
-      case aot::bit_or:
-        return applyMultiBinOp<aot, aot::bit_or, std::bit_or>(evaluatedVals);
-      case aot::bit_xor:
-        return applyMultiBinOp<aot, aot::bit_xor, std::bit_xor>(evaluatedVals);
-      case aot::modulus:
-        return applyMultiBinOp<aot, aot::modulus, std::modulus>(evaluatedVals);
-      case aot::divides:
-        return applyMultiBinOp<aot, aot::divides, std::divides>(evaluatedVals);
-      case aot::minus:
-        return applyMultiBinOp<aot, aot::minus, std::minus>(evaluatedVals);
-      case aot::multiplies:
-        return applyMultiBinOp<aot, aot::multiplies, std::multiplies>(
-            evaluatedVals);
-      case aot::negate:
-        return applyUnaryOp<aot, aot::negate, std::negate>(evaluatedVals);
-      case aot::plus:
-        return applyMultiBinOp<aot, aot::plus, std::plus>(evaluatedVals);
-      default:
-        return Var{};
-    }
-    __MC_BASIC_OPERATION_EVAL_END_RETURN(op, Var{})
-  });
+  auto e = evaluateOperator(
+      op, [&op, this](auto&& evaluatedVals) {
+        return applyOperator(op, evaluatedVals);
+      });
 
   stack_->return_(move(e));
 }
 
+template <class _Operator, class _Apply>
+Var SyntaxEvaluatorImpl::applyReportingTypeErrors(const _Operator& op,
+                                                  _Apply&& apply) {
+  __MC_BASIC_OPERATION_EVAL_START(op)
+  return apply();
+  __MC_BASIC_OPERATION_EVAL_END_RETURN(op, Var{})
+}
+
+/// Appliers dispatching on types of operand values
+template <class _Operator, class _OpType, _OpType _type,
+          template <class> class _std_op>
+Var applyMultiBin(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+                  const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const _Operator&>(e), [&] {
+        return evaluator.applyMultiBinOp<_OpType, _type, _std_op>(evals);
+      });
+}
+
+template <class _Operator, class _OpType, _OpType _type,
+          template <class> class _std_op>
+Var applyUnary(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+               const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const _Operator&>(e), [&] {
+        return evaluator.applyUnaryOp<_OpType, _type, _std_op>(evals);
+      });
+}
+
+Var applyPlus(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+              const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const ArithmaticalOperator&>(e), [&] {
+        if (Var concatenated; concatenate(evals, concatenated)) {
+          return concatenated;
+        }
+        return evaluator.applyMultiBinOp<aot, aot::plus, std::plus>(evals);
+      });
+}
+
+Var applyLogicalAnd(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+                    const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const LogicalOperator&>(e),
+      [&] { return evaluator.applyLogicalAndOp(evals); });
+}
+
+Var applyLogicalOr(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+                   const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const LogicalOperator&>(e),
+      [&] { return evaluator.applyLogicalOrOp(evals); });
+}
+
+template <template <class> class _compare>
+Var compareVars(SyntaxEvaluatorImpl& evaluator, const Evaluable& e,
+                const EvaluatedOnReadValues& evals) {
+  return evaluator.applyReportingTypeErrors(
+      static_cast<const ComparisonOperator&>(e), [&] {
+        Var first = evals.front();
+        Var second = evals.back();
+        return Var(_compare<void>{}(first, second));
+      });
+}
+
+Var applyNothing(SyntaxEvaluatorImpl&, const Evaluable&,
+                 const EvaluatedOnReadValues&) {
+  return Var{};
+}
+
+Var compareNothing(SyntaxEvaluatorImpl&, const Evaluable&,
+                   const EvaluatedOnReadValues&) {
+  return false;
+}
+
+template <aot _type, template <class> class _std_op>
+OperatorApplier arithmaticalApplier(bool typed) {
+  if (typed) {
+    return applyTyped<foldNumbers<_std_op>>;
+  }
+  return applyMultiBin<ArithmaticalOperator, aot, _type, _std_op>;
+}
+
+template <aot _type, template <class> class _std_op>
+OperatorApplier unaryArithmaticalApplier(bool typed) {
+  if (typed) {
+    return applyTyped<applyNumber<_std_op>>;
+  }
+  return applyUnary<ArithmaticalOperator, aot, _type, _std_op>;
+}
+
+template <cot _type, template <class> class _compare>
+OperatorApplier comparisonApplier(StaticType operandType) {
+  switch (operandType) {
+    case StaticType::number:
+      return compareTyped<_type, Number>;
+    case StaticType::string:
+      return compareTyped<_type, String>;
+    default:
+      return compareVars<_compare>;
+  }
+}
+
+OperatorApplier SyntaxEvaluatorImpl::applierOf(const ArithmaticalOperator& op) {
+  auto typed = op.operandType != StaticType::unknown;
+  switch (op.type) {
+    case aot::bit_and:
+      return arithmaticalApplier<aot::bit_and, std::bit_and>(typed);
+    case aot::bit_not:
+      return unaryArithmaticalApplier<aot::bit_not, std::bit_not>(typed);
+    case aot::bit_or:
+      return arithmaticalApplier<aot::bit_or, std::bit_or>(typed);
+    case aot::bit_xor:
+      return arithmaticalApplier<aot::bit_xor, std::bit_xor>(typed);
+    case aot::modulus:
+      return arithmaticalApplier<aot::modulus, std::modulus>(typed);
+    case aot::divides:
+      return arithmaticalApplier<aot::divides, std::divides>(typed);
+    case aot::minus:
+      return arithmaticalApplier<aot::minus, std::minus>(typed);
+    case aot::multiplies:
+      return arithmaticalApplier<aot::multiplies, std::multiplies>(typed);
+    case aot::negate:
+      return unaryArithmaticalApplier<aot::negate, std::negate>(typed);
+    case aot::plus:
+      if (op.operandType == StaticType::string) {
+        return applyTyped<concatenateStrings>;
+      }
+      return typed ? applyTyped<foldNumbers<std::plus>> : applyPlus;
+    default:
+      return applyNothing;
+  }
+}
+
+OperatorApplier SyntaxEvaluatorImpl::applierOf(const LogicalOperator& op) {
+  auto typed = op.operandType != StaticType::unknown;
+  switch (op.type) {
+    case lot::logical_and:
+      return typed ? applyTyped<foldBools<false>> : applyLogicalAnd;
+    case lot::logical_or:
+      return typed ? applyTyped<foldBools<true>> : applyLogicalOr;
+    case lot::logical_not:
+      if (typed) {
+        return applyTyped<negateBool>;
+      }
+      return applyUnary<LogicalOperator, lot, lot::logical_not,
+                        std::logical_not>;
+    default:
+      return applyNothing;
+  }
+}
+
+OperatorApplier SyntaxEvaluatorImpl::applierOf(const ComparisonOperator& op) {
+  switch (op.type) {
+    case cot::eq:
+      return comparisonApplier<cot::eq, std::equal_to>(op.operandType);
+    case cot::gt:
+      return comparisonApplier<cot::gt, std::greater>(op.operandType);
+    case cot::ge:
+      return comparisonApplier<cot::ge, std::greater_equal>(op.operandType);
+    case cot::lt:
+      return comparisonApplier<cot::lt, std::less>(op.operandType);
+    case cot::le:
+      return comparisonApplier<cot::le, std::less_equal>(op.operandType);
+    case cot::neq:
+      return comparisonApplier<cot::neq, std::not_equal_to>(op.operandType);
+    default:
+      return compareNothing;
+  }
+}
+
+Var SyntaxEvaluatorImpl::applyOperator(
+    const ArithmaticalOperator& op,
+    const EvaluatedOnReadValues& evaluatedVals) {
+  return applierOf(op)(*this, op, evaluatedVals);
+}
+
 void SyntaxEvaluatorImpl::eval(const ArthmSelfAssignOperator& op) {
+  stack_->return_(evalSelfAssign(op, nullptr));
+}
+
+Var SyntaxEvaluatorImpl::evalSelfAssign(const ArthmSelfAssignOperator& op,
+                                        const CompiledNode* compiled) {
   assert(op.params.size() == 2);
   __MC_BASIC_OPERATION_EVAL_START(op)
   evaluateLocalSymbols(op);
   auto var = op.params.front();
-  auto opStr = strJoin(op.type);
   __stackUnwindThrowIf(EvaluationError, !isType<Variable>(var.get()),
-                       "first argument of operator `", opStr,
+                       "first argument of operator `", op.type,
                        "` must be a variable");
 
-  auto varVal = evalAndReturn(var.get(), opStr);
+  auto varVal = compiled ? compiled->operands.front()(*this)
+                         : evalAndReturn(var.get(), strJoin(op.type));
   __stackUnwindThrowIf(EvaluationError, varVal.isNull(), "Variable ",
                        static_cast<const Variable*>(var.get())->name,
                        " has not been initialized yet");
 
-  auto paramVal = evalAndReturn(op.params.back().get(), opStr);
+  auto paramVal = compiled ? compiled->operands.back()(*this)
+                           : evalAndReturn(op.params.back().get(),
+                                           strJoin(op.type));
   __stackUnwindThrowIf(EvaluationError, paramVal.isNull(),
-                       "Parameter to operator `", opStr, "` evaluated to null");
+                       "Parameter to operator `", op.type,
+                       "` evaluated to null");
 
   varVal.detach();
-  std::vector<Var> operands = {varVal, paramVal};
+  // the detached value is owned here, or it is the unshared variable's own.
+  // As assign does, the sum replaces a reference to the variable's value,
+  // which is appended to when nothing else refers to it
+  if (op.type == asot::s_plus) {
+    auto& target = varVal.isRef() && varVal.asRef().use_count() == 1
+                       ? *varVal.asRef()
+                       : varVal;
+    if (!target.isRef() && _plusInPlace(target, paramVal)) {
+      if (&target != &varVal) {
+        varVal.assign(move(target));
+      }
+      return varVal;
+    }
+  }
+  std::array<Var, 2> operands = {varVal, paramVal};
   Var result;
   switch (op.type) {
     case asot::s_plus:
@@ -294,8 +600,8 @@ void SyntaxEvaluatorImpl::eval(const ArthmSelfAssignOperator& op) {
   }
 
   varVal.assign(move(result));
-  stack_->return_(move(varVal));
-  __MC_BASIC_OPERATION_EVAL_END(op)
+  return varVal;
+  __MC_BASIC_OPERATION_EVAL_END_RETURN(op, Var{})
 }
 
 void SyntaxEvaluatorImpl::eval(const LogicalOperator& op) {
@@ -305,107 +611,236 @@ void SyntaxEvaluatorImpl::eval(const LogicalOperator& op) {
     makeSureBinaryOp(op);
   }
 
-  auto e = evaluateOperator(op, [&op, this](auto&& evaluatedVals) {
-    __MC_BASIC_OPERATION_EVAL_START(op)
-    switch (op.type) {
-      case lot::logical_and:
-        return applyLogicalAndOp(evaluatedVals);
-      case lot::logical_or:
-        return applyLogicalOrOp(evaluatedVals);
-      case lot::logical_not:
-        return applyUnaryOp<lot, lot::logical_not, std::logical_not>(
-            evaluatedVals);
-      default:
-        return Var{};
-    }
-    __MC_BASIC_OPERATION_EVAL_END_RETURN(op, Var{})
-  });
+  auto e = evaluateOperator(
+      op, [&op, this](auto&& evaluatedVals) {
+        return applyOperator(op, evaluatedVals);
+      });
   stack_->return_(move(e));
 }
 
+Var SyntaxEvaluatorImpl::applyOperator(
+    const LogicalOperator& op, const EvaluatedOnReadValues& evaluatedVals) {
+  return applierOf(op)(*this, op, evaluatedVals);
+}
+
 void SyntaxEvaluatorImpl::eval(const ComparisonOperator& op) {
   makeSureSingleBinaryOp(op);
   auto e = evaluateOperator(op, [&op, this](auto&& evaluated) {
-    __MC_BASIC_OPERATION_EVAL_START(op)
-    auto __applyOp = [&](auto&& stdop) {
-      Var first = evaluated.front();
-      Var second = evaluated.back();
-      return stdop(first, second);
-    };
-
-    switch (op.type) {
-      case cot::eq:
-        return __applyOp(std::equal_to{});
-      case cot::gt:
-        return __applyOp(std::greater{});
-      case cot::ge:
-        return __applyOp(std::greater_equal{});
-      case cot::lt:
-        return __applyOp(std::less{});
-      case cot::le:
-        return __applyOp(std::less_equal{});
-      case cot::neq:
-        return __applyOp(std::not_equal_to{});
-      default:
-        return false;
-    }
-    __MC_BASIC_OPERATION_EVAL_END_RETURN(op, false)
+    return applyOperator(op, evaluated);
   });
   stack_->return_(move(e));
 }
 
-void SyntaxEvaluatorImpl::eval(const ListAlgorithm& op) {
-  Var finalEvaled;
-  Var vlist;
+Var SyntaxEvaluatorImpl::applyOperator(const ComparisonOperator& op,
+                                       const EvaluatedOnReadValues& evaluated) {
+  return applierOf(op)(*this, op, evaluated);
+}
 
-  evaluateLocalSymbols(op);
+/// Condition of a list algorithm evaluated on its items one by one, in a
+/// same rebound item context, or natively if it is a field predicate
+class ListItemCondition {
+ public:
+  ListItemCondition(SyntaxEvaluatorImpl* evaluator, const ListAlgorithm& op,
+                    const CompiledNode* compiled)
+      : evaluator_(evaluator),
+        op_(op),
+        compiled_(compiled ? &compiled->operands.back() : nullptr) {
+    if (op.fieldPredicate && !evaluator->dbCallback_ &&
+        FieldPredicate::appliesTo(*evaluator->stack_->top()->context)) {
+      predicate_ = op.fieldPredicate.get();
+    }
+  }
 
-  if (op.list) {
-    vlist = evalAndReturn(op.list.get(), strJoin(op.type));
+  bool test(const Var& item) {
+    if (bool matched = false; predicate_ && predicate_->test(item, matched)) {
+      ++itemIdx_;
+      return matched;
+    }
+    auto evaluated = apply(item);
+    if (!evaluated.isBool()) {
+      evaluator_->stackUnwindThrow<EvaluationError>(
+          "Invalid param type > operation: ",
+          SyntaxEvaluatorImpl::syntaxOf(op_),
+          "` > expected: `boolean` > real_val: `", evaluated.dump(), "`");
+    }
+    return evaluated.getValue<bool>();
   }
 
-  __stackUnwindThrowIf(EvaluationError, !vlist.isList(),
-                       "`@list` input of ListAlgorithm ", op.type,
-                       " was not evaluated to array type");
+  Var apply(const Var& item) {
+    return evaluator_->evalAndReturnOnItem(itemFrame_, op_.cond.get(),
+                                           strJoin(itemIdx_++), {item},
+                                           compiled_);
+  }
 
-  auto& list = vlist.asList();
-  int itemIdx = 0;
-  auto eval_impl = [this, &itemIdx, &op](const Var& data) {
-    auto evaluated = evalAndReturn(op.cond.get(), strJoin(itemIdx++),
-                                   ContextArguments{data});
-    __stackUnwindThrowIf(EvaluationError, !evaluated.isBool(),
-                         "Invalid param type > operation: ", syntaxOf(op),
-                         "` > expected: `boolean` > real_val: `",
-                         evaluated.dump(), "`");
-    return evaluated.getValue<bool>();
-  };
+ private:
+  SyntaxEvaluatorImpl* evaluator_;
+  const ListAlgorithm& op_;
+  const CompiledNode* compiled_;
+  const FieldPredicate* predicate_ = nullptr;
+  EvaluationFramePtr itemFrame_;
+  int itemIdx_ = 0;
+};
+
+void SyntaxEvaluatorImpl::eval(const ListAlgorithm& op) {
+  stack_->return_(evalListAlgorithm(op, nullptr));
+}
+
+Var SyntaxEvaluatorImpl::evalListAlgorithm(const ListAlgorithm& op,
+                                           const CompiledNode* compiled) {
+  Var finalEvaled;
 
+  evaluateLocalSymbols(op);
+
+  ListItemCondition cond{this, op, compiled};
   switch (op.type) {
-    case lsaot::any_of:
-      finalEvaled = std::any_of(std::begin(list), std::end(list), eval_impl);
+    case lsaot::any_of: {
+      bool found = false;
+      feedListItems(
+          op,
+          [&](const Var& item) {
+            found = cond.test(item);
+            return !found;
+          },
+          compiled);
+      finalEvaled = found;
       break;
+    }
     case lsaot::all_of:
-      finalEvaled = std::all_of(std::begin(list), std::end(list), eval_impl);
+      finalEvaled = feedListItems(
+          op, [&](const Var& item) { return cond.test(item); }, compiled);
       break;
     case lsaot::none_of:
-      finalEvaled = std::none_of(std::begin(list), std::end(list), eval_impl);
+      finalEvaled = feedListItems(
+          op, [&](const Var& item) { return !cond.test(item); }, compiled);
       break;
-    case lsaot::count_if:
-      finalEvaled = std::count_if(std::begin(list), std::end(list), eval_impl);
+    case lsaot::count_if: {
+      std::ptrdiff_t count = 0;
+      feedListItems(
+          op,
+          [&](const Var& item) {
+            count += cond.test(item);
+            return true;
+          },
+          compiled);
+      finalEvaled = count;
       break;
-    case lsaot::filter_if:
-      finalEvaled = filter_if(list, eval_impl);
+    }
+    case lsaot::filter_if: {
+      auto filtered = Var::list();
+      feedListItems(
+          op,
+          [&](const Var& item) {
+            if (cond.test(item)) {
+              filtered.add(item);
+            }
+            return true;
+          },
+          compiled);
+      finalEvaled = move(filtered);
       break;
-    case lsaot::transform:
-      finalEvaled = transform(list, [this, &itemIdx, &op](const Var& data) {
-        return evalAndReturn(op.cond.get(), strJoin(itemIdx++),
-                             ContextArguments{data});
-      });
+    }
+    case lsaot::transform: {
+      auto transformed = Var::list();
+      feedListItems(
+          op,
+          [&](const Var& item) {
+            transformed.add(cond.apply(item));
+            return true;
+          },
+          compiled);
+      finalEvaled = move(transformed);
+      break;
+    }
+    default:
       break;
+  }
+  return finalEvaled;
+}
+
+bool SyntaxEvaluatorImpl::feedListItems(const ListAlgorithm& op,
+                                        const ListItemConsumer& consume,
+                                        const CompiledNode* compiled) {
+  // closure of the list source, the first operand of the algorithm's closure
+  auto source = compiled ? &compiled->operands.front() : nullptr;
+  switch (op.source) {
+    case ListAlgorithm::Source::stage:
+      return feedStageItems(static_cast<const ListAlgorithm&>(*op.list),
+                            strJoin(op.type), consume, source);
+    case ListAlgorithm::Source::range:
+      return feedRangeItems(static_cast<const ModuleFI&>(*op.list),
+                            strJoin(op.type), consume, source);
     default:
       break;
   }
-  stack_->return_(move(finalEvaled));
+  Var vlist;
+  if (source) {
+    vlist = (*source)(*this);
+  } else if (op.list) {
+    vlist = evalAndReturn(op.list.get(), strJoin(op.type));
+  }
+
+  __stackUnwindThrowIf(EvaluationError, !vlist.isList(),
+                       "`@list` input of ListAlgorithm ", op.type,
+                       " was not evaluated to array type");
+
+  for (auto& item : std::as_const(vlist).asList()) {
+    if (!consume(item)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool SyntaxEvaluatorImpl::feedStageItems(const ListAlgorithm& stage,
+                                         String ctxtID,
+                                         const ListItemConsumer& consume,
+                                         const CompiledNode* compiled) {
+  bool completed = true;
+  __MC_STACK_START(strJoin(move(ctxtID), stage.typeID()), &stage);
+  // the consumer is invoked on its own frame, as if the stage was evaluated
+  // to a list first
+  auto stageFrame = stack_->top();
+  stageFrame->compiled = compiled;
+  auto passOn = [&](const Var& item) {
+    stack_->top(stageFrame->parent);
+    auto more = consume(item);
+    stack_->top(stageFrame);
+    return more;
+  };
+  ListItemCondition cond{this, stage, compiled};
+  if (stage.type == lsaot::transform) {
+    completed = feedListItems(
+        stage, [&](const Var& item) { return passOn(cond.apply(item)); },
+        compiled);
+  } else {
+    completed = feedListItems(
+        stage,
+        [&](const Var& item) { return !cond.test(item) || passOn(item); },
+        compiled);
+  }
+  __MC_STACK_END
+  stack_->pop();
+  return completed;
+}
+
+bool SyntaxEvaluatorImpl::feedRangeItems(const ModuleFI& range, String ctxtID,
+                                         const ListItemConsumer& consume,
+                                         const CompiledNode* compiled) {
+  bool completed = true;
+  __MC_STACK_START(strJoin(move(ctxtID), range.typeID()), &range);
+  auto rangeFrame = stack_->top();
+  rangeFrame->compiled = compiled;
+  auto bounds = compiled ? compiled->operands.front()(*this)
+                         : evalAndReturn(range.param.get());
+  completed = mdl::cif::range(bounds, [&](const Number& n) {
+    stack_->top(rangeFrame->parent);
+    auto more = consume(Var{n});
+    stack_->top(rangeFrame);
+    return more;
+  });
+  __MC_STACK_END
+  stack_->pop();
+  return completed;
 }
 
 template <class _FI>
@@ -442,39 +877,46 @@ void SyntaxEvaluatorImpl::eval(const MacroFI& macro) {
   assert((args.isNull() || args.isList()) &&
          "evaluated params must be null(aka void) or a list of arguments");
   stack_->top()->context->args(args.isNull() ? ContextArguments{}
-                                             : args.asList());
+                                             : std::as_const(args).asList());
   stack_->return_(evalAndReturn(macro.macro->evb.get()));
 }
 
 void SyntaxEvaluatorImpl::eval(const ObjectPropertyQuery& query) {
-  auto object = evalAndReturn(query.object.get());
-  do {
+  stack_->return_(evalPropertyQuery(query, nullptr));
+}
+
+Var SyntaxEvaluatorImpl::evalPropertyQuery(const ObjectPropertyQuery& query,
+                                           const CompiledNode* compiled) {
+  // closures of the object then of the path fields
+  auto operand = compiled ? std::data(compiled->operands) : nullptr;
+  auto object =
+      operand ? (*operand++)(*this) : evalAndReturn(query.object.get());
+  if (object.isNull()) {
+    return object;
+  }
+  for (auto& evbField : query.propertyPath) {
+    auto field = operand ? (*operand++)(*this) : evalAndReturn(evbField.get());
+    if (field.isString()) {
+      object = object.getPath(field.asString());
+    } else if (field.isInt()) {
+      object = object.getAt(field.getValue<size_t>());
+    } else {
+      stackUnwindThrow<EvaluationError>("Cannot evaluated to a valid path: ",
+                                        field.dump());
+    }
     if (object.isNull()) {
-      stack_->return_(Var{});
       break;
     }
-    for (auto& evbField : query.propertyPath) {
-      auto field = evalAndReturn(evbField.get());
-      if (field.isString()) {
-        object = object.getPath(field.asString());
-      } else if (field.isInt()) {
-        object = object.getAt(field.getValue<size_t>());
-      } else {
-        stackUnwindThrow<EvaluationError>("Cannot evaluated to a valid path: ",
-                                          field.dump());
-      }
-      if (object.isNull()) {
-        break;
-      }
-    }
-    stack_->return_(move(object));
-  } while (false);
+  }
+  return object;
 }
 
 void SyntaxEvaluatorImpl::eval(const Variable& variable) {
   auto val = stack_->top()->context->lookupVariable(variable.name);
   if (!val) {
     val = _findAndEvalNotInitializedVariableOrThrow(variable.name);
+  } else if (pendingVariables_ > 0 && val->isNull()) {
+    val = _evalIfPendingVariable(variable.name, val);
   }
   stack_->return_(*val);
 }
@@ -494,21 +936,40 @@ void SyntaxEvaluatorImpl::eval(const ContextArgumentsInfo& arginf) {
   }
 }
 
+/// Frames of stackless evaluables, pushed for their item arguments only,
+/// declare no variables
+static const LocalVariables* _localVariablesOf(const EvaluationFrame& frame) {
+  if (!frame.evb->useStack()) {
+    return nullptr;
+  }
+  return static_cast<const UseStackEvaluable*>(frame.evb)->localVariables.get();
+}
+
+/// Closure of the value of a variable declared by `frame`, if it is compiled
+static const CompiledNode* _compiledValueOf(
+    const EvaluationFrame& frame, const LocalVariables& localVariables,
+    LocalVariables::const_iterator itVariable) {
+  if (!frame.compiled || frame.compiled->evb != frame.evb) {
+    return nullptr;
+  }
+  return &frame.compiled->locals[static_cast<size_t>(
+      std::distance(std::begin(localVariables), itVariable))];
+}
+
 Var* SyntaxEvaluatorImpl::_findAndEvalNotInitializedVariableOrThrow(
     const String& variableName) {
   Var* val = nullptr;
   // loop through stack to find the not evaluated property
   auto currentFrame = stack_->top();
   do {
-    assert(currentFrame->evb->useStack());
-    auto currentEvb = static_cast<const UseStackEvaluable*>(currentFrame->evb);
-    if (!currentEvb->localVariables) {
+    auto localVariables = _localVariablesOf(*currentFrame);
+    if (!localVariables) {
       currentFrame = currentFrame->parent;
       continue;
     }
 
-    if (auto itProp = currentEvb->localVariables->find(variableName);
-        itProp != std::end(*currentEvb->localVariables)) {
+    if (auto itProp = localVariables->find(variableName);
+        itProp != std::end(*localVariables)) {
       auto& varInfo = itProp->second;
       auto varStatus = currentFrame->variableStatus(variableName);
       // if variable was not found on top context, then it should not be
@@ -517,7 +978,9 @@ Var* SyntaxEvaluatorImpl::_findAndEvalNotInitializedVariableOrThrow(
       __stackUnwindThrowIf(
           EvaluationError, varStatus == VariableStatus::Evaluating,
           "Cyclic reference detected on variable: $", variableName);
-      val = evaluateSingleVar(currentFrame, variableName, varInfo);
+      val = evaluateSingleVar(
+          currentFrame, variableName, varInfo,
+          _compiledValueOf(*currentFrame, *localVariables, itProp));
       break;
     }
     currentFrame = currentFrame->parent;
@@ -527,6 +990,32 @@ Var* SyntaxEvaluatorImpl::_findAndEvalNotInitializedVariableOrThrow(
   return val;
 }
 
+Var* SyntaxEvaluatorImpl::_evalIfPendingVariable(const String& variableName,
+                                                 Var* val) {
+  // on-demand variables hold null until their first read
+  auto currentFrame = stack_->top();
+  do {
+    if (auto localVariables = _localVariablesOf(*currentFrame)) {
+      if (auto itProp = localVariables->find(variableName);
+          itProp != std::end(*localVariables)) {
+        auto varStatus = currentFrame->variableStatus(variableName);
+        __stackUnwindThrowIf(
+            EvaluationError, varStatus == VariableStatus::Evaluating,
+            "Cyclic reference detected on variable: $", variableName);
+        if (varStatus == VariableStatus::NotEvaluated) {
+          --pendingVariables_;
+          val = evaluateSingleVar(
+              currentFrame, variableName, itProp->second,
+              _compiledValueOf(*currentFrame, *localVariables, itProp));
+        }
+        break;
+      }
+    }
+    currentFrame = currentFrame->parent;
+  } while (currentFrame);
+  return val;
+}
+
 void SyntaxEvaluatorImpl::_evalOnStack(const Evaluable* e, String ctxtID,
                                        ContextArguments ctxtInput) {
   assert(e);
@@ -538,11 +1027,31 @@ void SyntaxEvaluatorImpl::_evalOnStack(const Evaluable* e, String ctxtID,
   __MC_STACK_END
 }
 
+Var SyntaxEvaluatorImpl::evalCompiledOnStack(const CompiledNode& node,
+                                             String frameID,
+                                             ContextArguments ctxtData) {
+  __MC_STACK_START(move(frameID), node.evb, move(ctxtData));
+  stack_->top()->compiled = &node;
+  stack_->return_(node.invoke(node, *this));
+  __MC_STACK_END
+  return stackTakeReturnedVal();
+}
+
 Var SyntaxEvaluatorImpl::evalAndReturn(const Evaluable* e, String ctxtID,
                                        ContextArguments ctxtData) {
   Var evaluated;
   if (e) {
-    if (e->useStack()) {
+    if (auto compiled = compiledOf(e)) {
+      // pushed on the frame the caller asked for, as the interpreter does
+      evaluated = e->useStack()
+                      ? evalCompiledOnStack(
+                            *compiled,
+                            strJoin(move(ctxtID),
+                                    static_cast<const UseStackEvaluable*>(e)
+                                        ->typeID()),
+                            move(ctxtData))
+                      : compiled->invoke(*compiled, *this);
+    } else if (e->useStack()) {
       _evalOnStack(e, move(ctxtID), move(ctxtData));
       evaluated = stackTakeReturnedVal();
     } else {
@@ -556,6 +1065,43 @@ Var SyntaxEvaluatorImpl::evalAndReturn(const Evaluable* e, String ctxtID,
   return evaluated;
 }
 
+Var SyntaxEvaluatorImpl::evalAndReturnOnItem(EvaluationFramePtr& itemFrame,
+                                             const Evaluable* e, String ctxtID,
+                                             ContextArguments item,
+                                             const CompiledNode* compiled) {
+  if (!e) {
+    return {};
+  }
+  if (!compiled) {
+    compiled = compiledOf(e);
+  }
+  // stackless evaluables get a frame too, for the item to be their arguments
+  if (e->useStack()) {
+    ctxtID = strJoin(move(ctxtID),
+                     static_cast<const UseStackEvaluable*>(e)->typeID());
+  }
+  // the item is kept for a new frame if the context cannot be rebound
+  if (itemFrame && itemFrame->context->rebind(ctxtID, item)) {
+    itemFrame->returnedValue = Var{};
+    if (itemFrame->variableStatusMapPtr) {
+      itemFrame->variableStatusMapPtr->clear();
+    }
+    stack_->repush(itemFrame);
+  } else {
+    stack_->push(move(ctxtID), e, move(item));
+    itemFrame = stack_->top();
+  }
+  itemFrame->compiled = compiled;
+  try {
+    if (compiled) {
+      stack_->return_(compiled->invoke(*compiled, *this));
+    } else {
+      e->accept(this);
+    }
+  __MC_STACK_END
+  return stackTakeReturnedVal();
+}
+
 void SyntaxEvaluatorImpl::debugStackReturnedValue(const Var& e,
                                                   const Evaluable* evb) {
   if (dbCallback_ && evb) {
@@ -584,6 +1130,11 @@ void SyntaxEvaluatorImpl::debugStackReturnedValue(const Var& e,
   }
 }
 
+const CompiledNode* SyntaxEvaluatorImpl::compiledOf(const Evaluable* e) const {
+  auto& top = std::as_const(*stack_).top();
+  return top->compiled ? top->compiled->childOf(e) : nullptr;
+}
+
 Var& SyntaxEvaluatorImpl::stackReturnedVal() {
   return stack_->top()->returnedValue;
 }
@@ -597,12 +1148,14 @@ Var SyntaxEvaluatorImpl::stackTakeReturnedVal() {
 
 Var* SyntaxEvaluatorImpl::evaluateSingleVar(const EvaluationFramePtr& frame,
                                             const String& varname,
-                                            const VariableEvalInfo& vi) {
+                                            const VariableEvalInfo& vi,
+                                            const CompiledNode* compiled) {
   Var* ret = nullptr;
   auto savedFrame = stack_->top();
   stack_->top(frame);
   frame->startEvaluatingVar(varname);
-  auto val = evalAndReturn(vi.value.get(), varname);
+  auto val =
+      compiled ? (*compiled)(*this) : evalAndReturn(vi.value.get(), varname);
   if (vi.type == VariableEvalInfo::Declaration) {
     ret = frame->context->putVariable(varname, move(val));
   } else {
@@ -630,11 +1183,24 @@ void SyntaxEvaluatorImpl::evaluateLocalSymbols(const UseStackEvaluable& evb) {
     if (!currentFrame->variableStatusMapPtr) {
       currentFrame->variableStatusMapPtr = make_shared<VariableStatusMap>();
     }
+    auto& frameCompiled = currentFrame->compiled;
+    auto compiled = frameCompiled && frameCompiled->evb == &evb
+                        ? std::data(frameCompiled->locals)
+                        : nullptr;
     for (auto& [varname, var] : *(evb.localVariables)) {
+      auto compiledValue = compiled ? compiled++ : nullptr;
       auto varStatus = currentFrame->variableStatus(varname);
       assert(varStatus != VariableStatus::Evaluating);
-      if (varStatus != VariableStatus::Evaluated) {
-        evaluateSingleVar(currentFrame, varname, var);
+      if (varStatus != VariableStatus::Undefined) {
+        continue;
+      }
+      if (var.onDemand) {
+        // context might be reused and keeps value of last evaluation
+        currentFrame->context->putVariable(varname, {});
+        currentFrame->pendingVar(varname);
+        ++pendingVariables_;
+      } else {
+        evaluateSingleVar(currentFrame, varname, var, compiledValue);
       }
     }
   }
@@ -678,7 +1244,8 @@ Var SyntaxEvaluatorImpl::evaluateOperator(const _Operation& op,
                                           _Callable&& eval_func) {
   evaluateLocalSymbols(op);
   // evaluate all params
-  EvaluatedOnReadValues inlevals;
+  EvaluatedOnReadValues inlevals{&operandPools_};
+  inlevals.reserve(op.params.size());
   for (auto& p : op.params) {
     inlevals.emplace_back(this, *p);
   }
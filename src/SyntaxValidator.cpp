@@ -318,10 +318,21 @@ class SyntaxValidatorImpl : public EvaluatorIF {
     return error_indicator;
   }
 
+  /// Operators specialized for proven types of their operands are marked
+  /// with the type
+  template <class T>
+  static String symbolOf(
+      const _OperatorBase<T, typename T::OperatorType>& op) {
+    if (op.operandType == StaticType::unknown) {
+      return strJoin(op.type);
+    }
+    return strJoin(op.type, JASSTR("<"), op.operandType, JASSTR(">"));
+  }
+
   template <class T>
   void dumpPreUnaryOp(const _OperatorBase<T, typename T::OperatorType>& op) {
     os_ << JASSTR("(");
-    os_ << op.type;
+    os_ << symbolOf(op);
     if (op.params.empty()) {
       os_ << bookMarkError(JASSTR("Missing paramter"));
     } else {
@@ -339,26 +350,26 @@ class SyntaxValidatorImpl : public EvaluatorIF {
     os_ << JASSTR("(");
     if (op.params.size() < 2) {
       if (op.params.empty()) {
-        os_ << bookMarkError(JASSTR("Parameter is missing")) << op.type
+        os_ << bookMarkError(JASSTR("Parameter is missing")) << symbolOf(op)
             << bookMarkError(JASSTR("Parameter is missing"));
       } else {
         _eval(op.params[0].get());
-        os_ << JASSTR(" ") << op.type
+        os_ << JASSTR(" ") << symbolOf(op)
             << bookMarkError(JASSTR("Parameter is missing"));
       }
     } else {
       auto it = std::begin(op.params);
       _eval((*it).get());
-      os_ << JASSTR(' ') << op.type << JASSTR(' ');
+      os_ << JASSTR(' ') << symbolOf(op) << JASSTR(' ');
       _eval((*(++it)).get());
       if (!exact2) {
         while (++it != std::end(op.params)) {
-          os_ << JASSTR(' ') << op.type << JASSTR(' ');
+          os_ << JASSTR(' ') << symbolOf(op) << JASSTR(' ');
           _eval((*it).get());
         }
       } else {
         while (++it != std::end(op.params)) {
-          os_ << JASSTR(' ') << op.type << JASSTR(' ')
+          os_ << JASSTR(' ') << symbolOf(op) << JASSTR(' ')
               << bookMarkError(JASSTR("More than required parameters count"));
           _eval((*it).get());
         }
@@ -8,6 +8,14 @@
 #include <string_view>
 #include <vector>
 
+#include "details/CommonSubexpressionEliminator.h"
+#include "details/EvaluableArena.h"
+#include "details/FieldPredicate.h"
+#include "details/LazyDeclarations.h"
+#include "details/ListPipelines.h"
+#include "details/MacroInliner.h"
+#include "details/SnapshotReads.h"
+#include "details/TypeInference.h"
 #include "jas/EvalContextIF.h"
 #include "jas/EvaluableClasses.h"
 #include "jas/Exception.h"
@@ -47,6 +55,9 @@ struct TranslatorImpl {
 
   ModuleManager* moduleMgr_;
   ContextPtr context_;
+  Translator::Optimizations optimizations_;
+  Translator::Report report_;
+  std::shared_ptr<const SnapshotReads> snapshotReads_;
   std::vector<ParsingRuleCallback> translateCallbacks_ = {
       &TranslatorImpl::translateNoEffectOperations,    //
       &TranslatorImpl::translateOperations,            //
@@ -149,7 +160,7 @@ struct TranslatorImpl {
       type = VariableEvalInfo::Update;
     }
     if (!parent->localVariables) {
-      parent->localVariables = make_shared<LocalVariables>();
+      parent->localVariables = makeTreeShared<LocalVariables>();
     }
     auto varname = key.substr(namePos);
 
@@ -174,10 +185,10 @@ struct TranslatorImpl {
                                                               key.size() - 1}));
 
     if (!parent->localMacros) {
-      parent->localMacros = make_shared<LocalMacrosMap>();
+      parent->localMacros = makeTreeShared<LocalMacrosMap>();
     }
 
-    auto macro = make_shared<Macro>();
+    auto macro = makeTreeShared<Macro>();
     parent->localMacros->emplace(key.substr(1), macro);
     return DelayedTranslatedMacro{move(macro), evbExpr};
   }
@@ -897,11 +908,49 @@ struct TranslatorImpl {
   EvaluablePtr translate(const Var& jas, Translator::Strategy strategy) {
     __jas_throw_if(SyntaxError, jas.isNull(), JASSTR("Not an Evaluable: "),
                    jas.dump());
+    std::shared_ptr<EvaluableArena> arena;
+    if (optimizations_.arenaAllocation) {
+      arena = std::make_shared<EvaluableArena>();
+    }
+    EvaluableArena::Scope arenaScope{move(arena)};
+    EvaluablePtr evb;
     if (strategy == Translator::Strategy::AllowShorthand) {
       auto _jas = reconstructJAS(jas);
-      return translateImpl(nullptr, _jas);
+      evb = translateImpl(nullptr, _jas);
     } else {
-      return translateImpl(nullptr, jas);
+      evb = translateImpl(nullptr, jas);
+    }
+    optimize(evb);
+    return evb;
+  }
+
+  void optimize(const EvaluablePtr& evb) {
+    report_ = {};
+    if (optimizations_.inlineMacros) {
+      report_.inlinedMacroInvocations = inlineMacroInvocations(evb, context_);
+    }
+    if (optimizations_.fieldPredicates) {
+      report_.compiledPredicates = compileFieldPredicates(evb, context_);
+    }
+    if (optimizations_.eliminateCommonSubexpressions) {
+      report_.deduplicatedNodes = eliminateCommonSubexpressions(evb, context_);
+    }
+    if (optimizations_.lazyLocalVariables) {
+      report_.deferredVariables = deferPureDeclarations(evb, context_);
+    }
+    if (optimizations_.inferTypes) {
+      report_.specializedOperators = specializeOperators(evb, context_);
+    }
+    if (optimizations_.fuseListPipelines) {
+      report_.fusedPipelineStages = fuseListPipelines(evb, context_);
+    }
+    snapshotReads_.reset();
+    if (optimizations_.reuseUnchangedResults ||
+        optimizations_.projectSnapshots) {
+      auto reads = std::make_shared<SnapshotReads>();
+      if (collectSnapshotReads(evb, context_, *reads)) {
+        snapshotReads_ = move(reads);
+      }
     }
   }
 };
@@ -946,6 +995,22 @@ const std::set<StringView>& Translator::evaluableSpecifiers() {
   return TranslatorImpl::evaluableSpecifiers();
 }
 
+void Translator::setOptimizations(const Optimizations& optimizations) {
+  impl_->optimizations_ = optimizations;
+}
+
+const Translator::Optimizations& Translator::optimizations() const {
+  return impl_->optimizations_;
+}
+
+const Translator::Report& Translator::lastReport() const {
+  return impl_->report_;
+}
+
+std::shared_ptr<const SnapshotReads> Translator::snapshotReads() const {
+  return impl_->snapshotReads_;
+}
+
 Translator::Translator(ModuleManager* moduleMgr)
     : impl_(new TranslatorImpl(moduleMgr)) {}
 
@@ -1,6 +1,11 @@
 #include "jas/Var.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <charconv>
+#include <cstdint>
+#include <mutex>
 #include <optional>
 #include <typeindex>
 #include <variant>
@@ -22,7 +27,9 @@ using List = Var::List;
 using Dict = Var::Dict;
 using Ref = Var::Ref;
 
-#define VAR_POSIB_TYPES Null, Bool, Number, String, List, Dict, Ref
+using Lazy = std::shared_ptr<const Var::Source>;
+
+#define VAR_POSIB_TYPES Null, Bool, Number, String, List, Dict, Ref, Lazy
 enum class VarTypeIdx : size_t { VAR_POSIB_TYPES };
 
 static constexpr const CharType *indexToType(VarTypeIdx idx) {
@@ -49,6 +56,9 @@ static constexpr const CharType *indexToType(VarTypeIdx idx) {
     case VarTypeIdx::Null:
       ret = JASSTR("Null");
       break;
+    case VarTypeIdx::Lazy:
+      ret = JASSTR("Lazy");
+      break;
   }
   return ret;
 }
@@ -62,6 +72,67 @@ struct Var::ValueType : public ValueTypeBase {
   decltype(auto) asBase() { return static_cast<_Base &>(*this); }
   decltype(auto) asBase() const { return static_cast<const _Base &>(*this); }
 
+  ValueType(const ValueType &other) : _Base(other.asBase()) {
+    lazy.store(isLazy(), std::memory_order_release);
+  }
+  ValueType(ValueType &&other) noexcept : _Base(move(other.asBase())) {
+    lazy.store(isLazy(), std::memory_order_release);
+  }
+  /// Cached hash and frozen state are of the value replaced, they are reset
+  /// by accessing it for modification
+  ValueType &operator=(const ValueType &other) {
+    asBase() = other.asBase();
+    lazy.store(isLazy(), std::memory_order_release);
+    return *this;
+  }
+  ValueType &operator=(ValueType &&other) noexcept {
+    asBase() = move(other.asBase());
+    lazy.store(isLazy(), std::memory_order_release);
+    return *this;
+  }
+
+  bool isLazy() const { return std::holds_alternative<Lazy>(asBase()); }
+
+  /// Whether the value is of a source not converted yet. Const accessors
+  /// convert it, maybe of a value shared across threads, they read the value
+  /// only after seeing it cleared
+  std::atomic<bool> lazy{false};
+
+  /// Values converted from json, such as snapshots, are frozen until they
+  /// are accessed for modification. Structural hashes are cached on frozen
+  /// lists and dicts only, whose children are all frozen too. A child
+  /// reached for modification through its holders unfreezes them as well,
+  /// and one modified through another holder is shared, then all cached
+  /// hashes are dropped as holders of a value are not known
+  bool frozen = false;
+  /// epoch of the cached hash, 0 if none
+  mutable std::atomic<size_t> hashEpoch{0};
+  mutable std::atomic<size_t> hash{0};
+
+  static std::atomic<size_t> &sharedModifications() {
+    static std::atomic<size_t> epoch{1};
+    return epoch;
+  }
+
+  bool hashValid() const {
+    return frozen && hashEpoch.load(std::memory_order_acquire) ==
+                         sharedModifications().load(std::memory_order_acquire);
+  }
+
+  void cacheHash(size_t h) const {
+    auto epoch = sharedModifications().load(std::memory_order_acquire);
+    hash.store(h, std::memory_order_relaxed);
+    hashEpoch.store(epoch, std::memory_order_release);
+  }
+
+  void unfreeze(bool shared) {
+    if (frozen && shared) {
+      sharedModifications().fetch_add(1, std::memory_order_acq_rel);
+    }
+    frozen = false;
+    hashEpoch.store(0, std::memory_order_relaxed);
+  }
+
 #define __var_get_impl(T)                                                     \
   try {                                                                       \
     return std::get<T>(asBase());                                             \
@@ -84,21 +155,15 @@ struct Var::ValueType : public ValueTypeBase {
 
 template <class _NumberType>
 static std::optional<_NumberType> _toNumber(const StringView &snum) {
-  try {
-    return std::stoi(snum);
-  } catch (const std::exception &) {
-    return
+  _NumberType out;
+  const std::from_chars_result result =
+      std::from_chars(snum.data(), snum.data() + snum.size(), out);
+  if (result.ec == std::errc::invalid_argument ||
+      result.ec == std::errc::result_out_of_range) {
+    return std::nullopt;
   }
 
-  //  _NumberType out;
-  //  const std::from_chars_result result =
-  //      std::from_chars(snum.data(), snum.data() + snum.size(), out);
-  //  if (result.ec == std::errc::invalid_argument ||
-  //      result.ec == std::errc::result_out_of_range) {
-  //    return std::nullopt;
-  //  }
-
-  //  return out;
+  return out;
 }
 
 template <class _Var, class _Iterator>
@@ -151,11 +216,22 @@ static _Var *_find(_Var *j, const Var::Path &path) {
     __Var_type_check(Type);                     \
   }
 
+static void _accessForModification(const Var::ValuePtr &value) {
+  value->unfreeze(value.use_count() > 1);
+}
+
 template <class T = Null>
 auto makeValue(T v = {}) {
   return make_shared<Var::ValueType>(move(v));
 }
 
+template <class T>
+auto makeFrozenValue(T v) {
+  auto value = makeValue(move(v));
+  value->frozen = true;
+  return value;
+}
+
 void throwOutOfRange(bool cond, size_t i) {
   __jas_throw_if(OutOfRange, cond, "Out of bound access: ", i);
 }
@@ -245,6 +321,8 @@ bool Var::empty() const {
 }
 
 void Var::clear() {
+  materialize(value);
+  _accessForModification(value);
   std::visit(
       [](auto &v) {
         if constexpr (std::is_same_v<std::decay_t<decltype(v)>, Ref>) {
@@ -357,10 +435,14 @@ Var Var::list(List list) { return Var{move(list)}; }
 
 Var Var::dict(Dict dict) { return Var{move(dict)}; }
 
-size_t Var::typeID() const { return value->index(); }
+size_t Var::typeID() const {
+  materialize(value);
+  return value->index();
+}
 
+// a lazy value is of its type once converted by isRef
 #define __Var_is_type_impl(Type) \
-  std::holds_alternative<Type>(*value) || (isRef() && asRef()->is##Type())
+  (isRef() ? asRef()->is##Type() : std::holds_alternative<Type>(*value))
 
 bool Var::isNumber() const { return __Var_is_type_impl(Number); }
 
@@ -378,19 +460,37 @@ bool Var::isDict() const { return __Var_is_type_impl(Dict); }
 
 bool Var::isNull() const { return __Var_is_type_impl(Null); }
 
-bool Var::isRef() const { return std::holds_alternative<Ref>(*value); }
+bool Var::isRef() const {
+  materialize(value);
+  return std::holds_alternative<Ref>(*value);
+}
 
 #define __Var_as_impl(Type) isRef() ? asRef()->as##Type() : value->get<Type>()
 
-Number &Var::asNumber() { return __Var_as_impl(Number); }
+Number &Var::asNumber() {
+  _accessForModification(value);
+  return __Var_as_impl(Number);
+}
 
-String &Var::asString() { return __Var_as_impl(String); }
+String &Var::asString() {
+  _accessForModification(value);
+  return __Var_as_impl(String);
+}
 
-bool &Var::asBool() { return __Var_as_impl(Bool); }
+bool &Var::asBool() {
+  _accessForModification(value);
+  return __Var_as_impl(Bool);
+}
 
-List &Var::asList() { return __Var_as_impl(List); }
+List &Var::asList() {
+  _accessForModification(value);
+  return __Var_as_impl(List);
+}
 
-Dict &Var::asDict() { return __Var_as_impl(Dict); }
+Dict &Var::asDict() {
+  _accessForModification(value);
+  return __Var_as_impl(Dict);
+}
 
 Ref &Var::asRef() { return std::get<Ref>(value->asBase()); }
 
@@ -449,7 +549,12 @@ const Dict Var::getDict(Dict onFailure) const {
 }
 
 Var &Var::assign(Var e) {
-  *value = *e.value;
+  _accessForModification(value);
+  if (e.useCount() == 1) {
+    *value = std::move(*e.value);
+  } else {
+    *value = *e.value;
+  }
   return *this;
 }
 
@@ -468,6 +573,7 @@ bool Var::detach(long shouldDetachCount) {
 
 void Var::becomeNull() {
   if (useCount() == 1) {
+    _accessForModification(value);
     *value = Null{};
   } else {
     value = makeValue();
@@ -482,6 +588,182 @@ Var Var::clone() const {
 
 String Var::dump() const { return JsonTrait::dump(toJson()); }
 
+static size_t _hashCombine(size_t seed, size_t h) {
+  return seed ^ (h + 0x9e3779b97f4a7c15ULL + (seed << 6) + (seed >> 2));
+}
+
+size_t Var::hash() const {
+  bool cacheable = true;
+  return structuralHash(cacheable);
+}
+
+size_t Var::structuralHash(bool &cacheable) const {
+  if (isRef()) {
+    // the referred value is modified without its holders being accessed
+    cacheable = false;
+    return asRef()->structuralHash(cacheable);
+  }
+  if (value->hashValid()) {
+    return value->hash.load(std::memory_order_relaxed);
+  }
+  cacheable = cacheable && value->frozen;
+  auto seed = static_cast<size_t>(typeID());
+  auto h = _hashCombine(
+      seed, std::visit(
+                [&cacheable](auto &&v) -> size_t {
+                  using PT = std::decay_t<decltype(v)>;
+                  if constexpr (std::is_same_v<PT, Number>) {
+                    // -0.0 == 0.0
+                    return std::hash<Number::UnderlyingType>{}(
+                        v.value == 0 ? 0 : v.value);
+                  } else if constexpr (std::is_same_v<PT, String>) {
+                    return std::hash<String>{}(v);
+                  } else if constexpr (std::is_same_v<PT, Bool>) {
+                    return v ? 1 : 2;
+                  } else if constexpr (std::is_same_v<PT, List>) {
+                    size_t h = v.size();
+                    for (auto &item : v) {
+                      h = _hashCombine(h, item.structuralHash(cacheable));
+                    }
+                    return h;
+                  } else if constexpr (std::is_same_v<PT, Dict>) {
+                    size_t h = v.size();
+                    for (auto &[key, item] : v) {
+                      h = _hashCombine(h, std::hash<String>{}(key));
+                      h = _hashCombine(h, item.structuralHash(cacheable));
+                    }
+                    return h;
+                  } else {
+                    return 0;
+                  }
+                },
+                value->asBase()));
+  if (cacheable && (isList() || isDict())) {
+    value->cacheHash(h);
+  }
+  return h;
+}
+
+namespace {
+
+/// A node of a json that is held by `holder`
+class JsonNodeSource : public Var::Source {
+ public:
+  JsonNodeSource(std::shared_ptr<const Json> holder, const Json &node)
+      : holder_(move(holder)), node_(node) {}
+
+  Var convert() const override {
+    if (JsonTrait::isObject(node_)) {
+      Dict dict;
+      JsonTrait::iterateObject(node_, [this, &dict](auto &&key, auto &&val) {
+        dict.emplace(key, viewOf(std::forward<decltype(val)>(val)));
+        return true;
+      });
+      return dict;
+    } else if (JsonTrait::isArray(node_)) {
+      List lst;
+      lst.reserve(JsonTrait::size(node_));
+      JsonTrait::iterateArray(node_, [this, &lst](auto &&item) {
+        lst.emplace_back(viewOf(std::forward<decltype(item)>(item)));
+        return true;
+      });
+      return lst;
+    } else {
+      return Var(node_);
+    }
+  }
+
+ private:
+  /// Children of a node yielded by value are held by their own views
+  template <class _Json>
+  Var viewOf(_Json &&child) const {
+    if constexpr (std::is_lvalue_reference_v<_Json>) {
+      return Var::lazy(std::make_shared<JsonNodeSource>(holder_, child));
+    } else {
+      auto holder = std::make_shared<const Json>(std::move(child));
+      auto &node = *holder;
+      return Var::lazy(std::make_shared<JsonNodeSource>(move(holder), node));
+    }
+  }
+
+  std::shared_ptr<const Json> holder_;
+  const Json &node_;
+};
+
+}  // namespace
+
+Var Var::lazy(std::shared_ptr<const Source> source) {
+  Var value;
+  if (source) {
+    value.value = makeValue<Lazy>(move(source));
+    value.value->lazy.store(true, std::memory_order_release);
+  }
+  return value;
+}
+
+Var Var::view(std::shared_ptr<const Json> json) {
+  if (!json) {
+    return {};
+  }
+  auto &node = *json;
+  return lazy(std::make_shared<JsonNodeSource>(move(json), node));
+}
+
+/// Lock of a lazy value while its conversion is installed. Sources are
+/// converted outside of it, as they may convert other values
+static std::mutex &_conversionLock(const void *value) {
+  static std::array<std::mutex, 64> locks;
+  auto i = reinterpret_cast<std::uintptr_t>(value) / alignof(std::max_align_t);
+  return locks[i % locks.size()];
+}
+
+void Var::materialize(const ValuePtr &value) {
+  while (value->lazy.load(std::memory_order_acquire)) {
+    auto &lock = _conversionLock(value.get());
+    Lazy source;
+    {
+      std::lock_guard<std::mutex> guard{lock};
+      if (!value->lazy.load(std::memory_order_relaxed)) {
+        return;
+      }
+      source = std::get<Lazy>(value->asBase());
+    }
+    // the source is released by replacing the value
+    auto converted = source->convert();
+    // the value is of a source, such as a snapshot, that is never modified.
+    // Its children are lazy values frozen once converted, or new scalars
+    auto freezeScalar = [](const Var &child) {
+      if (child.value.use_count() == 1 &&
+          !std::holds_alternative<List>(*child.value) &&
+          !std::holds_alternative<Dict>(*child.value) &&
+          !std::holds_alternative<Ref>(*child.value)) {
+        child.value->frozen = true;
+      }
+    };
+    if (converted.value.use_count() == 1) {
+      if (auto list = std::get_if<List>(&converted.value->asBase())) {
+        std::for_each(std::begin(*list), std::end(*list), freezeScalar);
+      } else if (auto dict = std::get_if<Dict>(&converted.value->asBase())) {
+        for (auto &[key, child] : *dict) {
+          freezeScalar(child);
+        }
+      }
+    }
+    std::lock_guard<std::mutex> guard{lock};
+    // converted by another thread meanwhile
+    if (!value->lazy.load(std::memory_order_relaxed) ||
+        std::get<Lazy>(value->asBase()) != source) {
+      continue;
+    }
+    value->frozen = true;
+    if (converted.value.use_count() == 1) {
+      *value = move(*converted.value);
+    } else {
+      *value = *converted.value;
+    }
+  }
+}
+
 Var::ValuePtr Var::fromJson(const Json &json) {
   if (JsonTrait::isObject(json)) {
     Dict dict;
@@ -489,24 +771,24 @@ Var::ValuePtr Var::fromJson(const Json &json) {
       dict.emplace(key, Var{val});
       return true;
     });
-    return makeValue(move(dict));
+    return makeFrozenValue(move(dict));
   } else if (JsonTrait::isArray(json)) {
     List lst;
     JsonTrait::iterateArray(json, [&lst](auto &&item) {
       lst.emplace_back(Var{item});
       return true;
     });
-    return makeValue(move(lst));
+    return makeFrozenValue(move(lst));
   } else if (JsonTrait::isString(json)) {
-    return makeValue(JsonTrait::get<String>(json));
+    return makeFrozenValue(JsonTrait::get<String>(json));
   } else if (JsonTrait::isDouble(json)) {
-    return makeValue<Number>(JsonTrait::get<Double>(json));
+    return makeFrozenValue<Number>(JsonTrait::get<Double>(json));
   } else if (JsonTrait::isInt(json)) {
-    return makeValue<Number>(JsonTrait::get<Int>(json));
+    return makeFrozenValue<Number>(JsonTrait::get<Int>(json));
   } else if (JsonTrait::isBool(json)) {
-    return makeValue(JsonTrait::get<Bool>(json));
+    return makeFrozenValue(JsonTrait::get<Bool>(json));
   } else {
-    return makeValue<Null>();
+    return makeFrozenValue(Null{});
   }
 }
 
@@ -517,6 +799,11 @@ bool operator==(const Var &first, const Var &second) {
     return *first.asRef() == second;
   } else if (second.isRef()) {
     return first == *second.asRef();
+  } else if (first.value->hashValid() && second.value->hashValid() &&
+             first.value->hash.load(std::memory_order_relaxed) !=
+                 second.value->hash.load(std::memory_order_relaxed)) {
+    // hashes are cached on frozen values only, which are never stale
+    return false;
   } else if (first.typeID() == second.typeID()) {
     return std::visit(
         [&second](auto &&v) {
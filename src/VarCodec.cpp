@@ -0,0 +1,492 @@
+#include "jas/VarCodec.h"
+
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+
+namespace jas {
+
+namespace {
+
+template <class T>
+void _putBigEndian(std::string& out, T value) {
+  for (auto shift = 8 * (sizeof(T) - 1);; shift -= 8) {
+    out += static_cast<char>((value >> shift) & 0xff);
+    if (shift == 0) {
+      break;
+    }
+  }
+}
+
+void _putHead(std::string& out, uint8_t fixed, uint8_t fixedLimit,
+              uint8_t code16, size_t size) {
+  if (size < fixedLimit) {
+    out += static_cast<char>(fixed | size);
+  } else if (size <= 0xffff) {
+    out += static_cast<char>(code16);
+    _putBigEndian(out, static_cast<uint16_t>(size));
+  } else {
+    out += static_cast<char>(code16 + 1);
+    _putBigEndian(out, static_cast<uint32_t>(size));
+  }
+}
+
+void _putInt(std::string& out, Var::Int i) {
+  if (i >= 0 && i < 0x80) {
+    out += static_cast<char>(i);
+  } else if (i < 0 && i >= -32) {
+    out += static_cast<char>(0xe0 | (i & 0x1f));
+  } else if (i >= 0 && i <= 0xff) {
+    out += '\xcc';
+    out += static_cast<char>(i);
+  } else if (i >= 0 && i <= 0xffff) {
+    out += '\xcd';
+    _putBigEndian(out, static_cast<uint16_t>(i));
+  } else if (i >= 0 && i <= 0xffffffffll) {
+    out += '\xce';
+    _putBigEndian(out, static_cast<uint32_t>(i));
+  } else if (i >= std::numeric_limits<int8_t>::min() && i < 0) {
+    out += '\xd0';
+    out += static_cast<char>(i);
+  } else if (i >= std::numeric_limits<int16_t>::min() && i < 0) {
+    out += '\xd1';
+    _putBigEndian(out, static_cast<uint16_t>(i));
+  } else if (i >= std::numeric_limits<int32_t>::min() && i < 0) {
+    out += '\xd2';
+    _putBigEndian(out, static_cast<uint32_t>(i));
+  } else {
+    out += '\xd3';
+    _putBigEndian(out, static_cast<uint64_t>(i));
+  }
+}
+
+void _putString(std::string& out, const String& str) {
+  if constexpr (sizeof(CharType) == 1) {
+    _putHead(out, 0xa0, 32, 0xda, str.size());
+    out.append(reinterpret_cast<const char*>(str.data()), str.size());
+  } else {
+    std::string utf8;
+    for (size_t i = 0; i < str.size(); ++i) {
+      auto code = static_cast<uint32_t>(str[i]);
+      // surrogate pairs of 2 bytes wide characters
+      if (sizeof(CharType) == 2 && code >= 0xd800 && code < 0xdc00 &&
+          i + 1 < str.size()) {
+        code = 0x10000 + ((code - 0xd800) << 10) +
+               (static_cast<uint32_t>(str[++i]) - 0xdc00);
+      }
+      if (code < 0x80) {
+        utf8 += static_cast<char>(code);
+      } else if (code < 0x800) {
+        utf8 += static_cast<char>(0xc0 | (code >> 6));
+        utf8 += static_cast<char>(0x80 | (code & 0x3f));
+      } else if (code < 0x10000) {
+        utf8 += static_cast<char>(0xe0 | (code >> 12));
+        utf8 += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        utf8 += static_cast<char>(0x80 | (code & 0x3f));
+      } else {
+        utf8 += static_cast<char>(0xf0 | (code >> 18));
+        utf8 += static_cast<char>(0x80 | ((code >> 12) & 0x3f));
+        utf8 += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+        utf8 += static_cast<char>(0x80 | (code & 0x3f));
+      }
+    }
+    _putHead(out, 0xa0, 32, 0xda, utf8.size());
+    out += utf8;
+  }
+}
+
+String _fromUtf8(std::string_view utf8) {
+  if constexpr (sizeof(CharType) == 1) {
+    return String(reinterpret_cast<const CharType*>(utf8.data()),
+                  utf8.size());
+  } else {
+    String str;
+    for (size_t i = 0; i < utf8.size();) {
+      auto lead = static_cast<uint8_t>(utf8[i++]);
+      auto trailing = lead >= 0xf0 ? 3 : lead >= 0xe0 ? 2 : lead >= 0xc0;
+      uint32_t code = trailing == 0 ? lead : lead & (0x3f >> trailing);
+      for (; trailing > 0 && i < utf8.size(); --trailing) {
+        code = (code << 6) | (static_cast<uint8_t>(utf8[i++]) & 0x3f);
+      }
+      if (sizeof(CharType) == 2 && code >= 0x10000) {
+        code -= 0x10000;
+        str += static_cast<CharType>(0xd800 + (code >> 10));
+        str += static_cast<CharType>(0xdc00 + (code & 0x3ff));
+      } else {
+        str += static_cast<CharType>(code);
+      }
+    }
+    return str;
+  }
+}
+
+class VarDecoder {
+ public:
+  /// Maps and arrays in `data` are decoded when first accessed if it is
+  /// held by `holder`
+  VarDecoder(std::string_view data, std::shared_ptr<const void> holder = {})
+      : data_(data), holder_(std::move(holder)) {}
+
+  Var decode() {
+    Var value;
+    if (!decodeValue(value) || pos_ != data_.size()) {
+      return {};
+    }
+    return value;
+  }
+
+ private:
+  bool decodeValue(Var& value) {
+    uint8_t code = 0;
+    if (!get(code)) {
+      return false;
+    }
+    if (code < 0x80) {
+      value = Var(Var::Int{code});
+    } else if (code >= 0xe0) {
+      value = Var(Var::Int{static_cast<int8_t>(code)});
+    } else if (code < 0x90) {
+      return decodeMap(code & 0x0f, value);
+    } else if (code < 0xa0) {
+      return decodeArray(code & 0x0f, value);
+    } else if (code < 0xc0) {
+      return decodeString(code & 0x1f, value);
+    } else {
+      return decodeTyped(code, value);
+    }
+    return true;
+  }
+
+  bool decodeTyped(uint8_t code, Var& value) {
+    switch (code) {
+      case 0xc0:
+        value = Var{};
+        return true;
+      case 0xc2:
+      case 0xc3:
+        value = Var(code == 0xc3);
+        return true;
+      case 0xca: {
+        uint32_t bits = 0;
+        float f = 0;
+        if (!get(bits)) {
+          return false;
+        }
+        std::memcpy(&f, &bits, sizeof(f));
+        value = Var(static_cast<Var::Double>(f));
+        return true;
+      }
+      case 0xcb: {
+        uint64_t bits = 0;
+        Var::Double d = 0;
+        if (!get(bits)) {
+          return false;
+        }
+        std::memcpy(&d, &bits, sizeof(d));
+        value = Var(d);
+        return true;
+      }
+      case 0xcc:
+        return decodeInt<uint8_t>(value);
+      case 0xcd:
+        return decodeInt<uint16_t>(value);
+      case 0xce:
+        return decodeInt<uint32_t>(value);
+      case 0xcf:
+        return decodeInt<uint64_t>(value);
+      case 0xd0:
+        return decodeInt<int8_t>(value);
+      case 0xd1:
+        return decodeInt<int16_t>(value);
+      case 0xd2:
+        return decodeInt<int32_t>(value);
+      case 0xd3:
+        return decodeInt<int64_t>(value);
+      case 0xc4:
+      case 0xd9:
+        return decodeSized<uint8_t>(&VarDecoder::decodeString, value);
+      case 0xc5:
+      case 0xda:
+        return decodeSized<uint16_t>(&VarDecoder::decodeString, value);
+      case 0xc6:
+      case 0xdb:
+        return decodeSized<uint32_t>(&VarDecoder::decodeString, value);
+      case 0xdc:
+        return decodeSized<uint16_t>(&VarDecoder::decodeArray, value);
+      case 0xdd:
+        return decodeSized<uint32_t>(&VarDecoder::decodeArray, value);
+      case 0xde:
+        return decodeSized<uint16_t>(&VarDecoder::decodeMap, value);
+      case 0xdf:
+        return decodeSized<uint32_t>(&VarDecoder::decodeMap, value);
+      default:
+        return false;
+    }
+  }
+
+  template <class T>
+  bool decodeInt(Var& value) {
+    T i = 0;
+    if (!get(i)) {
+      return false;
+    }
+    // unsigned integers out of range are kept as doubles
+    if (static_cast<uint64_t>(i) >
+            static_cast<uint64_t>(std::numeric_limits<Var::Int>::max()) &&
+        std::is_unsigned_v<T>) {
+      value = Var(static_cast<Var::Double>(i));
+    } else {
+      value = Var(static_cast<Var::Int>(i));
+    }
+    return true;
+  }
+
+  template <class T>
+  bool decodeSized(bool (VarDecoder::*decodeOf)(size_t, Var&), Var& value) {
+    T size = 0;
+    return get(size) && (this->*decodeOf)(size, value);
+  }
+
+  bool decodeString(size_t size, Var& value) {
+    if (data_.size() - pos_ < size) {
+      return false;
+    }
+    value = Var(_fromUtf8(data_.substr(pos_, size)));
+    pos_ += size;
+    return true;
+  }
+
+  bool decodeArray(size_t size, Var& value) {
+    Var::List list;
+    list.reserve(std::min(size, data_.size() - pos_));
+    for (size_t i = 0; i < size; ++i) {
+      if (!decodeChild(list.emplace_back())) {
+        return false;
+      }
+    }
+    value = Var(std::move(list));
+    return true;
+  }
+
+  bool decodeMap(size_t size, Var& value) {
+    Var::Dict dict;
+    for (size_t i = 0; i < size; ++i) {
+      Var key;
+      if (!decodeValue(key) || !key.isString()) {
+        return false;
+      }
+      Var item;
+      if (!decodeChild(item)) {
+        return false;
+      }
+      dict.insert_or_assign(std::move(key.asString()), std::move(item));
+    }
+    value = Var(std::move(dict));
+    return true;
+  }
+
+  bool decodeChild(Var& value) {
+    if (!holder_ || pos_ >= data_.size() || !_isContainer(data_[pos_])) {
+      return decodeValue(value);
+    }
+    auto begin = pos_;
+    if (!skip()) {
+      return false;
+    }
+    value = lazyDecodeVar(data_.substr(begin, pos_ - begin), holder_);
+    return true;
+  }
+
+  static bool _isContainer(char c) {
+    auto code = static_cast<uint8_t>(c);
+    return (code >= 0x80 && code < 0xa0) || (code >= 0xdc && code <= 0xdf);
+  }
+
+  /// Skips a value, jumping over strings by their sizes
+  bool skip() {
+    uint8_t code = 0;
+    if (!get(code)) {
+      return false;
+    }
+    size_t items = 0;
+    if (code < 0x80 || code >= 0xe0 || code == 0xc0 || code == 0xc2 ||
+        code == 0xc3) {
+      return true;
+    } else if (code < 0x90) {
+      items = 2 * (code & 0x0f);
+    } else if (code < 0xa0) {
+      items = code & 0x0f;
+    } else if (code < 0xc0) {
+      return advance(code & 0x1f);
+    } else {
+      switch (code) {
+        case 0xcc:
+        case 0xd0:
+          return advance(1);
+        case 0xcd:
+        case 0xd1:
+          return advance(2);
+        case 0xca:
+        case 0xce:
+        case 0xd2:
+          return advance(4);
+        case 0xcb:
+        case 0xcf:
+        case 0xd3:
+          return advance(8);
+        case 0xc4:
+        case 0xd9:
+          return skipSized<uint8_t>(1, items) && advance(items);
+        case 0xc5:
+        case 0xda:
+          return skipSized<uint16_t>(1, items) && advance(items);
+        case 0xc6:
+        case 0xdb:
+          return skipSized<uint32_t>(1, items) && advance(items);
+        case 0xdc:
+          return skipSized<uint16_t>(1, items) && skipItems(items);
+        case 0xdd:
+          return skipSized<uint32_t>(1, items) && skipItems(items);
+        case 0xde:
+          return skipSized<uint16_t>(2, items) && skipItems(items);
+        case 0xdf:
+          return skipSized<uint32_t>(2, items) && skipItems(items);
+        default:
+          return false;
+      }
+    }
+    return skipItems(items);
+  }
+
+  template <class T>
+  bool skipSized(size_t factor, size_t& items) {
+    T size = 0;
+    if (!get(size)) {
+      return false;
+    }
+    items = factor * size;
+    return true;
+  }
+
+  bool skipItems(size_t items) {
+    for (size_t i = 0; i < items; ++i) {
+      if (!skip()) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  bool advance(size_t size) {
+    if (data_.size() - pos_ < size) {
+      return false;
+    }
+    pos_ += size;
+    return true;
+  }
+
+  template <class T>
+  bool get(T& value) {
+    using Unsigned = std::make_unsigned_t<T>;
+    if (data_.size() - pos_ < sizeof(T)) {
+      return false;
+    }
+    Unsigned bits = 0;
+    for (size_t i = 0; i < sizeof(T); ++i) {
+      bits = static_cast<Unsigned>(
+          (sizeof(T) > 1 ? bits << 8 : 0) |
+          static_cast<uint8_t>(data_[pos_++]));
+    }
+    value = static_cast<T>(bits);
+    return true;
+  }
+
+  std::string_view data_;
+  std::shared_ptr<const void> holder_;
+  size_t pos_ = 0;
+};
+
+/// MessagePack data of a map or an array, held by `holder`
+class VarDataSource : public Var::Source {
+ public:
+  VarDataSource(std::string_view data, std::shared_ptr<const void> holder)
+      : data_(data), holder_(std::move(holder)) {}
+
+  Var convert() const override { return VarDecoder{data_, holder_}.decode(); }
+
+ private:
+  std::string_view data_;
+  std::shared_ptr<const void> holder_;
+};
+
+}  // namespace
+
+void encodeVar(const Var& value, std::string& out) {
+  if (value.isRef()) {
+    encodeVar(*value.asRef(), out);
+  } else if (value.isDict()) {
+    auto& dict = value.asDict();
+    _putHead(out, 0x80, 16, 0xde, dict.size());
+    for (auto& [key, item] : dict) {
+      _putString(out, key);
+      encodeVar(item, out);
+    }
+  } else if (value.isList()) {
+    auto& list = value.asList();
+    _putHead(out, 0x90, 16, 0xdc, list.size());
+    for (auto& item : list) {
+      encodeVar(item, out);
+    }
+  } else if (value.isString()) {
+    _putString(out, value.asString());
+  } else if (value.isInt()) {
+    _putInt(out, value.getInt());
+  } else if (value.isDouble()) {
+    uint64_t bits = 0;
+    auto d = value.getDouble();
+    std::memcpy(&bits, &d, sizeof(bits));
+    out += '\xcb';
+    _putBigEndian(out, bits);
+  } else if (value.isBool()) {
+    out += value.asBool() ? '\xc3' : '\xc2';
+  } else {
+    out += '\xc0';
+  }
+}
+
+std::string encodeVar(const Var& value) {
+  std::string out;
+  encodeVar(value, out);
+  return out;
+}
+
+Var decodeVar(std::string_view data) { return VarDecoder{data}.decode(); }
+
+String digestVar(const Var& value) {
+  auto data = encodeVar(value);
+  // halves of two unrelated hashes, FNV-1a and the standard one
+  uint64_t fnv = 0xcbf29ce484222325ULL;
+  for (auto c : data) {
+    fnv = (fnv ^ static_cast<uint8_t>(c)) * 0x100000001b3ULL;
+  }
+  uint64_t halves[] = {
+      fnv, static_cast<uint64_t>(std::hash<std::string>{}(data))};
+  String digest;
+  digest.reserve(32);
+  for (auto half : halves) {
+    for (auto shift = 60;; shift -= 4) {
+      digest += JASSTR("0123456789abcdef")[(half >> shift) & 0xf];
+      if (shift == 0) {
+        break;
+      }
+    }
+  }
+  return digest;
+}
+
+Var lazyDecodeVar(std::string_view data, std::shared_ptr<const void> holder) {
+  return Var::lazy(std::make_shared<VarDataSource>(data, std::move(holder)));
+}
+
+}  // namespace jas
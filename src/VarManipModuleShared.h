@@ -1,5 +1,8 @@
 #pragma once
 
+#include <map>
+#include <set>
+
 #include "jas/FunctionModuleBaseT.h"
 
 namespace jas {
@@ -24,6 +27,16 @@ inline Var &variable_detach(Var &var) {
       return func(evaluator->evalAndReturn(param.get()));               \
     }                                                              \
     String moduleName() const override { return JASSTR(#module); } \
+    bool functionIsPure(const StringView &funcName) const override { \
+      return module##_pure_funcs.count(funcName) != 0;             \
+    }                                                              \
+    StaticType functionReturnType(const StringView &funcName)      \
+        const override {                                           \
+      auto it = module##_return_types.find(funcName);              \
+      return it != std::end(module##_return_types)                 \
+                 ? it->second                                      \
+                 : StaticType::unknown;                            \
+    }                                                              \
     const FunctionsMap &_funcMap() const override {                \
       const static FunctionsMap _ =
 
@@ -38,6 +51,15 @@ inline Var &variable_detach(Var &var) {
     return module;                                                     \
   }
 
+/// Functions that do not detach and modify their first argument
+#define __module_pure_funcs(module, ...) \
+  static const std::set<StringView> module##_pure_funcs = {__VA_ARGS__}
+
+/// Functions that always return values of a same type
+#define __module_return_types(module, ...)                  \
+  static const std::map<StringView, StaticType, std::less<>> \
+      module##_return_types = {__VA_ARGS__}
+
 #define __module_register_func(module, func_name) \
   { module##_func_##func_name, module##_##func_name }
 
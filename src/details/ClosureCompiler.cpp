@@ -0,0 +1,336 @@
+#include "ClosureCompiler.h"
+
+#include <cassert>
+
+#include "EvaluationStack.h"
+#include "SideEffects.h"
+
+namespace jas {
+
+using std::move;
+
+namespace {
+
+Var invokeNull(const CompiledNode&, SyntaxEvaluatorImpl&) { return {}; }
+
+Var invokeConstant(const CompiledNode& node, SyntaxEvaluatorImpl&) {
+  return Var::ref(static_cast<const Constant*>(node.evb)->value);
+}
+
+/// Evaluables of which the interpreter's evaluation is taken as is
+template <class _Evaluable>
+Var invokeNative(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  auto& evb = static_cast<const _Evaluable&>(*node.evb);
+  evaluator.SyntaxEvaluatorImpl::eval(evb);
+  Var evaluated;
+  std::swap(evaluated, evaluator.stackReturnedVal());
+  return evaluated;
+}
+
+void evaluateLocalSymbols(const CompiledNode& node,
+                          SyntaxEvaluatorImpl& evaluator) {
+  if (!node.locals.empty()) {
+    evaluator.evaluateLocalSymbols(
+        static_cast<const UseStackEvaluable&>(*node.evb));
+  }
+}
+
+Var invokeList(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  auto evaluated = Var::list();
+  for (auto& item : node.operands) {
+    evaluated.add(item(evaluator));
+  }
+  return evaluated;
+}
+
+Var invokeDict(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  evaluateLocalSymbols(node, evaluator);
+  auto evaluated = Var::dict();
+  auto itOperand = std::begin(node.operands);
+  for (auto& [key, _] : static_cast<const EvaluableDict*>(node.evb)->value) {
+    evaluated.add(key, (*itOperand++)(evaluator));
+  }
+  return evaluated.empty() ? Var{} : evaluated;
+}
+
+Var invokeOperator(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  evaluateLocalSymbols(node, evaluator);
+  EvaluatedOnReadValues operands{&evaluator.operandPools_};
+  operands.reserve(node.operands.size());
+  for (auto& operand : node.operands) {
+    operands.emplace_back(&evaluator, operand);
+  }
+  return node.apply(evaluator, *node.evb, operands);
+}
+
+Var invokeSelfAssign(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  return evaluator.evalSelfAssign(
+      static_cast<const ArthmSelfAssignOperator&>(*node.evb), &node);
+}
+
+Var invokeListAlgorithm(const CompiledNode& node,
+                        SyntaxEvaluatorImpl& evaluator) {
+  return evaluator.evalListAlgorithm(
+      static_cast<const ListAlgorithm&>(*node.evb), &node);
+}
+
+Var invokePropertyQuery(const CompiledNode& node,
+                        SyntaxEvaluatorImpl& evaluator) {
+  return evaluator.evalPropertyQuery(
+      static_cast<const ObjectPropertyQuery&>(*node.evb), &node);
+}
+
+/// Modules evaluate their params themselves, through the interpreter that
+/// finds closures of the params on the frame of invocation
+Var invokeModuleFunction(const CompiledNode& node,
+                         SyntaxEvaluatorImpl& evaluator) {
+  auto& fi = static_cast<const ModuleFI&>(*node.evb);
+  evaluateLocalSymbols(node, evaluator);
+  return fi.module->eval(fi.name, fi.param, &evaluator);
+}
+
+Var invokeContextFunction(const CompiledNode& node,
+                          SyntaxEvaluatorImpl& evaluator) {
+  evaluateLocalSymbols(node, evaluator);
+  auto param = node.operands.front()(evaluator);
+  return evaluator.stack_->top()->context->invoke(
+      static_cast<const ContextFI&>(*node.evb).name, param);
+}
+
+Var invokeReturn(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  evaluateLocalSymbols(node, evaluator);
+  return node.operands.front()(evaluator);
+}
+
+Var invokeMacro(const CompiledNode& node, SyntaxEvaluatorImpl& evaluator) {
+  evaluateLocalSymbols(node, evaluator);
+  auto args = node.operands.front()(evaluator);
+  assert((args.isNull() || args.isList()) &&
+         "evaluated params must be null(aka void) or a list of arguments");
+  evaluator.stack_->top()->context->args(
+      args.isNull() ? ContextArguments{} : std::as_const(args).asList());
+  return (*node.target)(evaluator);
+}
+
+/// Operators must have the param count that the interpreter validates
+bool hasValidParamCount(const ArithmaticalOperator& op) {
+  return (op.type == aot::bit_not || op.type == aot::negate)
+             ? op.params.size() == 1
+             : op.params.size() >= 2;
+}
+
+bool hasValidParamCount(const LogicalOperator& op) {
+  return op.type == lot::logical_not ? op.params.size() == 1
+                                     : op.params.size() >= 2;
+}
+
+bool hasValidParamCount(const ComparisonOperator& op) {
+  return op.params.size() == 2;
+}
+
+/// Binds each evaluable of a tree to the invoker of its type and to closures
+/// of its children, pushing frames for them as the interpreter does
+class ClosureCompiler : public EvaluatorIF {
+ public:
+  ClosureCompiler(const EvalContextPtr& context, CompiledProgram& program)
+      : context_(context), program_(program) {}
+
+  void run(const EvaluablePtr& root) {
+    program_.root = root;
+    compile(root.get(), {}, program_.entry);
+  }
+
+ private:
+  /// Returns whether the subtree of `evb` is free of side effects and declares
+  /// no variables. Frames of such operators and dicts are not pushed, since
+  /// nothing can observe or store anything via their context path
+  bool compile(const Evaluable* evb, String ctxtID, CompiledNode& node) {
+    node.evb = evb;
+    if (!evb) {
+      node.invoke = invokeNull;
+      return true;
+    }
+    auto parent = std::exchange(node_, &node);
+    auto parentPure = std::exchange(pure_, true);
+    auto parentFrameless = std::exchange(frameless_, false);
+    evb->accept(this);
+    auto pure = pure_ && isPure(evb);
+    if (evb->useStack()) {
+      node.framed = !(frameless_ && pure);
+      node.frameID = strJoin(
+          move(ctxtID), static_cast<const UseStackEvaluable*>(evb)->typeID());
+    }
+    node_ = parent;
+    pure_ = parentPure;
+    frameless_ = parentFrameless;
+    return pure;
+  }
+
+  bool isPure(const Evaluable* evb) const {
+    SideEffectFree sideEffectFree{context_};
+    evb->accept(&sideEffectFree);
+    return sideEffectFree.pure &&
+           !(evb->useStack() && static_cast<const UseStackEvaluable*>(evb)
+                                    ->hasLocalVariables());
+  }
+
+  void compileOperand(const Evaluable* evb, String ctxtID,
+                      CompiledNode& operand) {
+    auto pure = compile(evb, move(ctxtID), operand);
+    pure_ = pure_ && pure;
+  }
+
+  /// Operands are allocated first, for closures to refer to them in place
+  void compileOperands(const Evaluables& evbs, const String& ctxtID) {
+    auto& operands = node_->operands;
+    operands.resize(evbs.size());
+    for (size_t i = 0; i < evbs.size(); ++i) {
+      compileOperand(evbs[i].get(), ctxtID, operands[i]);
+    }
+  }
+
+  void compileLocals(const UseStackEvaluable& evb) {
+    if (!evb.hasLocalVariables()) {
+      return;
+    }
+    auto& locals = node_->locals;
+    locals.resize(evb.localVariables->size());
+    auto itLocal = std::begin(locals);
+    for (auto& [varname, var] : *evb.localVariables) {
+      compileOperand(var.value.get(), varname, *itLocal++);
+    }
+  }
+
+  template <class _Operator>
+  void compileOperator(const _Operator& op) {
+    compileLocals(op);
+    compileOperands(op.params, {});
+    if (hasValidParamCount(op)) {
+      node_->invoke = invokeOperator;
+      node_->apply = SyntaxEvaluatorImpl::applierOf(op);
+      frameless_ = !op.hasLocalSymbols();
+    } else {
+      node_->invoke = invokeNative<_Operator>;
+    }
+  }
+
+  void compileParam(const EvaluablePtr& param) {
+    node_->operands.resize(1);
+    compileOperand(param.get(), {}, node_->operands.front());
+  }
+
+  void eval(const Constant&) override { node_->invoke = invokeConstant; }
+  void eval(const EvaluableDict& v) override {
+    compileLocals(v);
+    // dict of a single variable declaration returns the variable itself
+    if (v.value.empty()) {
+      node_->invoke = invokeNative<EvaluableDict>;
+      return;
+    }
+    node_->invoke = invokeDict;
+    node_->operands.resize(v.value.size());
+    auto itOperand = std::begin(node_->operands);
+    for (auto& [key, value] : v.value) {
+      compileOperand(value.get(), strJoin(key, '.'), *itOperand++);
+    }
+    frameless_ = !v.hasLocalSymbols();
+  }
+  void eval(const EvaluableList& v) override {
+    node_->invoke = invokeList;
+    node_->operands.resize(v.value.size());
+    for (size_t i = 0; i < v.value.size(); ++i) {
+      compileOperand(v.value[i].get(), strJoin(i, '.'), node_->operands[i]);
+    }
+  }
+  void eval(const ArithmaticalOperator& op) override { compileOperator(op); }
+  void eval(const LogicalOperator& op) override { compileOperator(op); }
+  void eval(const ComparisonOperator& op) override { compileOperator(op); }
+  void eval(const ArthmSelfAssignOperator& op) override {
+    compileLocals(op);
+    compileOperands(op.params, strJoin(op.type));
+    node_->invoke = invokeSelfAssign;
+  }
+  /// Operands are the list source then the condition. Stages and ranges are
+  /// fed from by their own closures, then their frames are pushed by the
+  /// algorithm instead of the closures
+  void eval(const ListAlgorithm& op) override {
+    compileLocals(op);
+    node_->operands.resize(2);
+    compileOperand(op.list.get(), strJoin(op.type), node_->operands.front());
+    compileOperand(op.cond.get(), {}, node_->operands.back());
+    node_->invoke = invokeListAlgorithm;
+  }
+  void eval(const ModuleFI& fi) override {
+    compileLocals(fi);
+    compileParam(fi.param);
+    node_->invoke = invokeModuleFunction;
+  }
+  void eval(const ContextFI& fi) override {
+    compileLocals(fi);
+    compileParam(fi.param);
+    node_->invoke = invokeContextFunction;
+  }
+  void eval(const EvaluatorFI& fi) override {
+    compileLocals(fi);
+    compileParam(fi.param);
+    if (fi.name == StringView{keyword::return_ + 1}) {
+      node_->invoke = invokeReturn;
+    } else {
+      node_->invoke = invokeNative<EvaluatorFI>;
+    }
+  }
+  /// Macro bodies are compiled once, a recursive invocation refers to the
+  /// body being compiled
+  void eval(const MacroFI& fi) override {
+    compileLocals(fi);
+    compileParam(fi.param);
+    node_->invoke = invokeMacro;
+    auto body = fi.macro->evb.get();
+    auto [itBody, inserted] = program_.macros.try_emplace(body);
+    node_->target = &itBody->second;
+    if (inserted) {
+      compile(body, {}, itBody->second);
+    }
+  }
+  void eval(const ObjectPropertyQuery& query) override {
+    auto& operands = node_->operands;
+    operands.resize(1 + query.propertyPath.size());
+    compileOperand(query.object.get(), {}, operands.front());
+    for (size_t i = 0; i < query.propertyPath.size(); ++i) {
+      compileOperand(query.propertyPath[i].get(), {}, operands[i + 1]);
+    }
+    node_->invoke = invokePropertyQuery;
+  }
+  void eval(const Variable&) override {
+    node_->invoke = invokeNative<Variable>;
+  }
+  void eval(const ContextArgument&) override {
+    node_->invoke = invokeNative<ContextArgument>;
+  }
+  void eval(const ContextArgumentsInfo&) override {
+    node_->invoke = invokeNative<ContextArgumentsInfo>;
+  }
+
+  const EvalContextPtr& context_;
+  CompiledProgram& program_;
+  CompiledNode* node_ = nullptr;
+  bool pure_ = true;
+  bool frameless_ = false;
+};
+
+}  // namespace
+
+std::shared_ptr<CompiledProgram> compileClosures(
+    const EvaluablePtr& root, const EvalContextPtr& context) {
+  auto program = std::make_shared<CompiledProgram>();
+  if (root) {
+    if (context) {
+      auto& rootContext = *context;
+      program->contextType = typeid(rootContext);
+    }
+    ClosureCompiler{context, *program}.run(root);
+  }
+  return program;
+}
+
+}  // namespace jas
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "CompiledNode.h"
+#include "jas/EvalContextIF.h"
+
+namespace jas {
+
+/// Compiles an evaluable tree to closures bound to the closures of their
+/// children, for a root context of the type of `context`. Frames of
+/// side-effect free operators and dicts are not pushed
+std::shared_ptr<CompiledProgram> compileClosures(const EvaluablePtr& root,
+                                                 const EvalContextPtr& context);
+
+}  // namespace jas
@@ -0,0 +1,245 @@
+#include "CommonSubexpressionEliminator.h"
+
+#include <unordered_map>
+#include <vector>
+
+#include "EvaluableTraversal.h"
+#include "jas/EvaluableClasses.h"
+
+namespace jas {
+
+using std::move;
+
+namespace {
+
+/// Describes an evaluable without its children
+struct NodeSignature : public EvaluatorIF {
+  NodeSignature(const EvalContextPtr& context) : context(context) {}
+
+  void eval(const Constant& v) override {
+    tag = strJoin(JASSTR("C"), v.value.dump());
+    pure = true;
+  }
+  void eval(const EvaluableDict& v) override {
+    tag = JASSTR("D");
+    for (auto& [key, _] : v.value) {
+      tag += strJoin(key.size(), JASSTR(":"), key);
+    }
+    pure = true;
+  }
+  void eval(const EvaluableList&) override {
+    tag = JASSTR("L");
+    pure = true;
+  }
+  void eval(const ArithmaticalOperator& op) override {
+    tag = strJoin(JASSTR("A"), static_cast<int>(op.type));
+    pure = true;
+  }
+  void eval(const ArthmSelfAssignOperator& op) override {
+    tag = strJoin(JASSTR("S"), static_cast<int>(op.type));
+  }
+  void eval(const LogicalOperator& op) override {
+    tag = strJoin(JASSTR("G"), static_cast<int>(op.type));
+    pure = true;
+  }
+  void eval(const ComparisonOperator& op) override {
+    tag = strJoin(JASSTR("P"), static_cast<int>(op.type));
+    pure = true;
+  }
+  void eval(const ListAlgorithm& op) override {
+    tag = strJoin(JASSTR("H"), static_cast<int>(op.type));
+  }
+  void eval(const ModuleFI& fi) override {
+    tag = strJoin(JASSTR("M"), fi.module->moduleName(), JASSTR("."), fi.name);
+  }
+  void eval(const MacroFI& fi) override {
+    tag = strJoin(JASSTR("R"), fi.macro.get());
+  }
+  void eval(const ContextFI& fi) override {
+    tag = strJoin(JASSTR("F"), fi.name);
+    pure = context && context->functionIsPure(fi.name);
+  }
+  void eval(const EvaluatorFI& fi) override {
+    tag = strJoin(JASSTR("E"), fi.name);
+  }
+  void eval(const ObjectPropertyQuery&) override { tag = JASSTR("Q"); }
+  void eval(const Variable& v) override { tag = strJoin(JASSTR("V"), v.name); }
+  void eval(const ContextArgument& arg) override {
+    tag = strJoin(JASSTR("I"), arg.index);
+  }
+  void eval(const ContextArgumentsInfo& arginf) override {
+    tag = strJoin(JASSTR("N"), static_cast<int>(arginf.type));
+  }
+
+  const EvalContextPtr& context;
+  String tag;
+  bool pure = false;
+};
+
+struct NodeInfo {
+  size_t id = 0;
+  size_t size = 1;
+  bool pure = false;
+};
+
+class CommonSubexpressionEliminator {
+ public:
+  CommonSubexpressionEliminator(const EvalContextPtr& context)
+      : context_(context) {}
+
+  size_t run(const EvaluablePtr& root) {
+    analyze(root);
+    processRegion(root);
+    return eliminated_;
+  }
+
+ private:
+  struct Region {
+    UseStackEvaluable* host = nullptr;
+    std::unordered_map<size_t, size_t> counts;
+    std::unordered_map<size_t, String> hoisted;
+    std::vector<EvaluablePtr> hoistedValues;
+  };
+
+  const NodeInfo& analyze(const EvaluablePtr& evb) {
+    NodeSignature signature{context_};
+    evb->accept(&signature);
+
+    NodeInfo info;
+    info.pure = signature.pure;
+    if (evb->useStack()) {
+      info.pure = info.pure && !static_cast<const UseStackEvaluable*>(evb.get())
+                                    ->hasLocalSymbols();
+    }
+
+    auto key = move(signature.tag);
+    key += JASSTR("(");
+    forEachChild(evb.get(), [&](EvaluablePtr& child, ChildScope) {
+      auto& childInfo = analyze(child);
+      info.pure = info.pure && childInfo.pure;
+      info.size += childInfo.size;
+      key += strJoin(childInfo.id, JASSTR(","));
+    });
+    key += JASSTR(")");
+    info.id = structuralIDs_.emplace(move(key), structuralIDs_.size())
+                  .first->second;
+    return infos_[evb.get()] = info;
+  }
+
+  const NodeInfo* infoOf(const Evaluable* evb) const {
+    auto it = infos_.find(evb);
+    return it != std::end(infos_) ? &it->second : nullptr;
+  }
+
+  static UseStackEvaluable* hostOf(const EvaluablePtr& evb) {
+    if (!evb->useStack()) {
+      return nullptr;
+    }
+    // dict of a single variable declaration returns the variable itself
+    if (isType<EvaluableDict>(evb) &&
+        static_cast<const EvaluableDict*>(evb.get())->value.empty()) {
+      return nullptr;
+    }
+    return static_cast<UseStackEvaluable*>(evb.get());
+  }
+
+  void processRegion(const EvaluablePtr& root) {
+    Region region;
+    region.host = hostOf(root);
+    if (!region.host) {
+      forEachChild(root.get(), [this](EvaluablePtr& child, ChildScope) {
+        processRegion(child);
+      });
+      return;
+    }
+
+    countInherited(region, root.get(), 1);
+    rewriteInherited(region, root.get());
+    // hoisted values may contain duplications of other hoisted values
+    for (size_t i = 0; i < region.hoistedValues.size(); ++i) {
+      auto value = region.hoistedValues[i];
+      rewriteInherited(region, value.get());
+    }
+
+    if (!region.hoisted.empty()) {
+      auto& host = *region.host;
+      if (!host.localVariables) {
+        host.localVariables = makeTreeShared<LocalVariables>();
+      }
+      for (auto& value : region.hoistedValues) {
+        auto& varname = region.hoisted[infoOf(value.get())->id];
+        host.localVariables->emplace(
+            varname,
+            VariableEvalInfo{value, VariableEvalInfo::Declaration, true});
+      }
+    }
+
+    processIsolatedRegions(root.get());
+  }
+
+  void countInherited(Region& region, const Evaluable* evb, int step) {
+    forEachChild(evb, [&](EvaluablePtr& child, ChildScope scope) {
+      if (scope == ChildScope::Inherited) {
+        if (auto info = infoOf(child.get())) {
+          region.counts[info->id] += step;
+        }
+        countInherited(region, child.get(), step);
+      }
+    });
+  }
+
+  void rewriteInherited(Region& region, Evaluable* evb) {
+    forEachChild(evb, [&](EvaluablePtr& child, ChildScope scope) {
+      if (scope != ChildScope::Inherited) {
+        return;
+      }
+      auto info = infoOf(child.get());
+      if (!info || !info->pure || isType<Constant>(child) ||
+          (region.counts[info->id] < 2 && !region.hoisted.count(info->id))) {
+        rewriteInherited(region, child.get());
+        return;
+      }
+
+      auto [itVarname, firstOccurrence] = region.hoisted.try_emplace(info->id);
+      if (firstOccurrence) {
+        itVarname->second = strJoin(JASSTR("~cse"), varIdx_++);
+        child->parent = region.host;
+        region.hoistedValues.push_back(child);
+      } else {
+        // nodes of this occurrence are no longer part of the region
+        region.counts[info->id] -= 1;
+        countInherited(region, child.get(), -1);
+        eliminated_ += info->size;
+      }
+      child = makeVariable(evb, itVarname->second);
+    });
+  }
+
+  void processIsolatedRegions(const Evaluable* evb) {
+    forEachChild(evb, [this](EvaluablePtr& child, ChildScope scope) {
+      if (scope == ChildScope::Isolated) {
+        processRegion(child);
+      } else {
+        processIsolatedRegions(child.get());
+      }
+    });
+  }
+
+  const EvalContextPtr& context_;
+  std::unordered_map<String, size_t> structuralIDs_;
+  std::unordered_map<const Evaluable*, NodeInfo> infos_;
+  size_t varIdx_ = 0;
+  size_t eliminated_ = 0;
+};
+
+}  // namespace
+
+size_t eliminateCommonSubexpressions(const EvaluablePtr& root,
+                                     const EvalContextPtr& context) {
+  if (!root) {
+    return 0;
+  }
+  return CommonSubexpressionEliminator{context}.run(root);
+}
+
+}  // namespace jas
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Hoists structurally equal pure subtrees of a scope into on-demand local
+/// variables of that scope, then each of them is evaluated only once per
+/// evaluation. Returns number of eliminated nodes
+size_t eliminateCommonSubexpressions(const EvaluablePtr& root,
+                                     const EvalContextPtr& context);
+
+}  // namespace jas
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <map>
+#include <typeindex>
+#include <vector>
+
+#include "jas/SyntaxEvaluatorImpl.h"
+
+namespace jas {
+
+struct CompiledNode;
+using CompiledNodes = std::vector<CompiledNode>;
+
+/// Evaluable compiled to a function bound once to the closures of its
+/// children, it is invoked without going through `EvaluatorIF`
+struct CompiledNode {
+  using Invoker = Var (*)(const CompiledNode&, SyntaxEvaluatorImpl&);
+
+  Var operator()(SyntaxEvaluatorImpl& evaluator) const {
+    if (framed) {
+      return evaluator.evalCompiledOnStack(*this, frameID);
+    }
+    return invoke(*this, evaluator);
+  }
+
+  /// Closure of a child that the interpreter is asked to evaluate, such as a
+  /// function param that modules evaluate themselves, or one of its items
+  const CompiledNode* childOf(const Evaluable* e) const {
+    for (auto& operand : operands) {
+      if (operand.evb == e) {
+        return &operand;
+      }
+      if (!operand.framed && isType<EvaluableList>(operand.evb)) {
+        for (auto& item : operand.operands) {
+          if (item.evb == e) {
+            return &item;
+          }
+        }
+      }
+    }
+    return nullptr;
+  }
+
+  Invoker invoke = nullptr;
+  const Evaluable* evb = nullptr;
+  /// evaluated on a frame of its own as the interpreter does, identified by
+  /// `frameID`. Frames of side-effect free evaluables are not pushed
+  bool framed = false;
+  String frameID;
+  CompiledNodes operands;
+  /// values of local variables, in order of their declarations
+  CompiledNodes locals;
+  /// operator applier, bound to the operator and its operand type
+  OperatorApplier apply = nullptr;
+  /// body of an invoked macro
+  const CompiledNode* target = nullptr;
+};
+
+/// Closures of an evaluable tree compiled for a type of root context, since
+/// purity of context functions depends on it
+struct CompiledProgram {
+  EvaluablePtr root;
+  std::type_index contextType = typeid(void);
+  CompiledNode entry;
+  /// bodies of macros, compiled once for all of their invocations
+  std::map<const Evaluable*, CompiledNode> macros;
+};
+
+/// Operand of operators, evaluated on its first read only
+struct EvaluatedOnReadValue {
+  EvaluatedOnReadValue(SyntaxEvaluatorImpl* delegate, const Evaluable& e)
+      : delegate_(delegate), e_(&e) {}
+  EvaluatedOnReadValue(SyntaxEvaluatorImpl* delegate,
+                       const CompiledNode& compiled)
+      : delegate_(delegate), compiled_(&compiled) {}
+
+  operator Var() const { return value(); }
+
+  const Var& value() const {
+    if (!evaluated_) {
+      ed_ = compiled_ ? (*compiled_)(*delegate_) : delegate_->evalAndReturn(e_);
+      evaluated_ = true;
+    }
+    return ed_;
+  }
+
+  SyntaxEvaluatorImpl* delegate_;
+  const Evaluable* e_ = nullptr;
+  const CompiledNode* compiled_ = nullptr;
+  mutable Var ed_;
+  mutable bool evaluated_ = false;
+};
+
+}  // namespace jas
@@ -0,0 +1,77 @@
+#include "EvalResultLog.h"
+
+#include <cstdint>
+
+#include "jas/Json.h"
+
+namespace jas {
+
+namespace {
+
+constexpr size_t checksumLength = 8;
+
+uint32_t _checksum(const StringView& text) {
+  // FNV-1a
+  uint32_t hash = 2166136261u;
+  for (auto c : text) {
+    hash ^= static_cast<uint32_t>(c);
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+String _toHex(uint32_t value) {
+  String hex(checksumLength, JASSTR('0'));
+  for (auto it = hex.rbegin(); it != hex.rend(); ++it, value >>= 4) {
+    *it = JASSTR("0123456789abcdef")[value & 0xf];
+  }
+  return hex;
+}
+
+/// End of the json string starting at `begin`
+size_t _jsonStringEnd(const String& text, size_t begin) {
+  if (begin >= text.size() || text[begin] != JASSTR('"')) {
+    return String::npos;
+  }
+  for (auto i = begin + 1; i < text.size(); ++i) {
+    if (text[i] == JASSTR('\\')) {
+      ++i;
+    } else if (text[i] == JASSTR('"')) {
+      return i + 1;
+    }
+  }
+  return String::npos;
+}
+
+}  // namespace
+
+void writeLogRecord(OStream& ostrm, const String& contextPath,
+                    const Var& variables) {
+  auto content = strJoin(JsonTrait::dump(Var(contextPath).toJson()),
+                         JASSTR(" "), JsonTrait::dump(variables.toJson()));
+  ostrm << _toHex(_checksum(content)) << JASSTR(" ") << content
+        << JASSTR("\n");
+}
+
+bool readLogRecord(const String& line, EvalResultLogRecord& record) {
+  if (line.size() <= checksumLength + 1 ||
+      line[checksumLength] != JASSTR(' ')) {
+    return false;
+  }
+  auto content = StringView{line}.substr(checksumLength + 1);
+  if (line.compare(0, checksumLength, _toHex(_checksum(content))) != 0) {
+    return false;
+  }
+  auto pathBegin = checksumLength + 1;
+  auto pathEnd = _jsonStringEnd(line, pathBegin);
+  if (pathEnd == String::npos || pathEnd + 1 >= line.size()) {
+    return false;
+  }
+  record.contextPath =
+      Var(JsonTrait::parse(line.substr(pathBegin, pathEnd - pathBegin)))
+          .getString();
+  record.variables = line.substr(pathEnd + 1);
+  return true;
+}
+
+}  // namespace jas
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "jas/Var.h"
+
+namespace jas {
+
+/// A log of stored evaluation results is a sequence of lines, each holding
+/// the variables of one context:
+///   `<checksum> <context path as json string> <variables as json object>`
+/// The checksum covers the rest of the line, so a record torn by a crash is
+/// detected when the log is read back
+struct EvalResultLogRecord {
+  String contextPath;
+  String variables;
+};
+
+void writeLogRecord(OStream& ostrm, const String& contextPath,
+                    const Var& variables);
+/// Splits a line into its record, returns false if the line is damaged
+bool readLogRecord(const String& line, EvalResultLogRecord& record);
+
+}  // namespace jas
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <memory_resource>
+
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Monotonic buffer holding nodes and symbol tables of one translated tree.
+/// Every object allocated from it shares its ownership, so any node kept
+/// from the tree, even after its root is gone, keeps the whole buffer
+class EvaluableArena : public std::pmr::monotonic_buffer_resource {
+ public:
+  /// Makes objects owned by evaluable trees created in scope allocated from
+  /// the arena, a null arena keeps them on the heap
+  class Scope {
+   public:
+    Scope(std::shared_ptr<EvaluableArena> arena)
+        : saved_(treeMemoryResource()) {
+      if (arena) {
+        treeMemoryResource() = std::move(arena);
+      }
+    }
+    ~Scope() { treeMemoryResource() = std::move(saved_); }
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    std::shared_ptr<std::pmr::memory_resource> saved_;
+  };
+};
+
+}  // namespace jas
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "jas/EvaluableClasses.h"
+
+namespace jas {
+
+/// How a child is evaluated relatively to its parent
+enum class ChildScope {
+  /// same context data and arguments as its parent
+  Inherited,
+  /// own context arguments: list algorithm condition, module function param,
+  /// macro body
+  Isolated,
+};
+
+/// Visits child slots of an evaluable, used by translate-time passes that
+/// own the tree and may replace the visited slots
+template <class _Callback>
+class EvaluableChildrenVisitor : public EvaluatorIF {
+ public:
+  EvaluableChildrenVisitor(_Callback& cb) : cb_(cb) {}
+
+  void eval(const Constant&) override {}
+  void eval(const EvaluableDict& v) override {
+    visitLocalSymbols(v);
+    for (auto& [key, val] : mut(v).value) {
+      visit(val, ChildScope::Inherited);
+    }
+  }
+  void eval(const EvaluableList& v) override {
+    for (auto& val : mut(v).value) {
+      visit(val, ChildScope::Inherited);
+    }
+  }
+  void eval(const ArithmaticalOperator& op) override { visitOperator(op); }
+  void eval(const ArthmSelfAssignOperator& op) override { visitOperator(op); }
+  void eval(const LogicalOperator& op) override { visitOperator(op); }
+  void eval(const ComparisonOperator& op) override { visitOperator(op); }
+  void eval(const ListAlgorithm& op) override {
+    visitLocalSymbols(op);
+    visit(mut(op).list, ChildScope::Inherited);
+    visit(mut(op).cond, ChildScope::Isolated);
+  }
+  void eval(const ModuleFI& fi) override {
+    visitLocalSymbols(fi);
+    visit(mut(fi).param, ChildScope::Isolated);
+  }
+  void eval(const MacroFI& fi) override { visitFI(fi); }
+  void eval(const ContextFI& fi) override { visitFI(fi); }
+  void eval(const EvaluatorFI& fi) override { visitFI(fi); }
+  void eval(const ObjectPropertyQuery& query) override {
+    visit(mut(query).object, ChildScope::Inherited);
+    for (auto& p : mut(query).propertyPath) {
+      visit(p, ChildScope::Inherited);
+    }
+  }
+  void eval(const Variable&) override {}
+  void eval(const ContextArgument&) override {}
+  void eval(const ContextArgumentsInfo&) override {}
+
+ private:
+  template <class T>
+  static T& mut(const T& v) {
+    return const_cast<T&>(v);
+  }
+
+  void visit(EvaluablePtr& child, ChildScope scope) {
+    if (child) {
+      cb_(child, scope);
+    }
+  }
+
+  void visitLocalSymbols(const UseStackEvaluable& evb) {
+    if (evb.localMacros) {
+      for (auto& [name, macro] : *evb.localMacros) {
+        visit(macro->evb, ChildScope::Isolated);
+      }
+    }
+    if (evb.localVariables) {
+      for (auto& [name, var] : *evb.localVariables) {
+        visit(var.value, ChildScope::Inherited);
+      }
+    }
+  }
+
+  template <class _Operator>
+  void visitOperator(const _Operator& op) {
+    visitLocalSymbols(op);
+    for (auto& p : mut(op).params) {
+      visit(p, ChildScope::Inherited);
+    }
+  }
+
+  template <class _FI>
+  void visitFI(const _FI& fi) {
+    visitLocalSymbols(fi);
+    visit(mut(fi).param, ChildScope::Inherited);
+  }
+
+  _Callback& cb_;
+};
+
+/// cb(EvaluablePtr& child, ChildScope scope)
+template <class _Callback>
+void forEachChild(const Evaluable* evb, _Callback&& cb) {
+  if (evb) {
+    EvaluableChildrenVisitor<std::remove_reference_t<_Callback>> visitor{cb};
+    evb->accept(&visitor);
+  }
+}
+
+/// Copies nodes of an evaluable tree, local macros are shared with the origin
+class EvaluableCloner : public EvaluatorIF {
+ public:
+  static EvaluablePtr clone(const EvaluablePtr& evb, Evaluable* parent) {
+    if (!evb) {
+      return {};
+    }
+    EvaluableCloner cloner;
+    evb->accept(&cloner);
+    auto& cloned = cloner.cloned_;
+    cloned->parent = parent;
+    LocalMacrosMapPtr localMacros;
+    if (cloned->useStack()) {
+      auto& useStackEvb = static_cast<UseStackEvaluable&>(*cloned);
+      if (useStackEvb.localVariables) {
+        useStackEvb.localVariables =
+            makeTreeShared<LocalVariables>(*useStackEvb.localVariables);
+      }
+      localMacros = std::move(useStackEvb.localMacros);
+    }
+    forEachChild(cloned.get(), [&](EvaluablePtr& child, ChildScope) {
+      child = clone(child, cloned.get());
+    });
+    if (localMacros) {
+      static_cast<UseStackEvaluable&>(*cloned).localMacros =
+          std::move(localMacros);
+    }
+    return cloned;
+  }
+
+  void eval(const Constant& v) override { copy(v); }
+  void eval(const EvaluableDict& v) override { copy(v); }
+  void eval(const EvaluableList& v) override { copy(v); }
+  void eval(const ArithmaticalOperator& op) override { copy(op); }
+  void eval(const ArthmSelfAssignOperator& op) override { copy(op); }
+  void eval(const LogicalOperator& op) override { copy(op); }
+  void eval(const ComparisonOperator& op) override { copy(op); }
+  void eval(const ListAlgorithm& op) override { copy(op); }
+  void eval(const ModuleFI& fi) override { copy(fi); }
+  void eval(const MacroFI& fi) override { copy(fi); }
+  void eval(const ContextFI& fi) override { copy(fi); }
+  void eval(const EvaluatorFI& fi) override { copy(fi); }
+  void eval(const ObjectPropertyQuery& query) override { copy(query); }
+  void eval(const Variable& v) override { copy(v); }
+  void eval(const ContextArgument& arg) override { copy(arg); }
+  void eval(const ContextArgumentsInfo& arginf) override { copy(arginf); }
+
+ private:
+  template <class T>
+  void copy(const T& v) {
+    cloned_ = makeTreeShared<T>(v);
+  }
+
+  EvaluablePtr cloned_;
+};
+
+}  // namespace jas
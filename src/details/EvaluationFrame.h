@@ -10,6 +10,7 @@
 namespace jas {
 
 enum class VariableStatus;
+struct CompiledNode;
 class EvaluationFrame;
 using EvaluationFramePtr = std::shared_ptr<EvaluationFrame>;
 using VariableStatusMap = std::map<String, VariableStatus>;
@@ -35,6 +36,9 @@ class EvaluationFrame {
   EvalContextPtr context;
   Var returnedValue;
   const Evaluable* evb;
+  /// closure of `evb` if it is compiled, for its local variables and the
+  /// children evaluated through the interpreter
+  const CompiledNode* compiled = nullptr;
   VariableStatusMapPtr variableStatusMapPtr;
 
   VariableStatus variableStatus(const String& varname) const {
@@ -49,6 +53,10 @@ class EvaluationFrame {
     assert(variableStatusMapPtr);
     (*variableStatusMapPtr)[varname] = VariableStatus::Evaluated;
   }
+  void pendingVar(const String& varname) {
+    assert(variableStatusMapPtr);
+    (*variableStatusMapPtr)[varname] = VariableStatus::NotEvaluated;
+  }
   void startEvaluatingVar(const String& varname) {
     assert(variableStatusMapPtr);
     (*variableStatusMapPtr)[varname] = VariableStatus::Evaluating;
@@ -0,0 +1,205 @@
+#include "FieldPredicate.h"
+
+#include <typeinfo>
+
+#include "EvaluableTraversal.h"
+#include "ValueComparison.h"
+
+namespace jas {
+
+namespace {
+
+using SnapshotIdx = FieldPredicate::SnapshotIdx;
+
+/// Context functions reading a field of the item, and snapshot they read
+bool fieldSnapshot(const String& funcName, SnapshotIdx& snapshot) {
+  if (funcName == JASSTR("field") || funcName == JASSTR("field_cv")) {
+    snapshot = SnapshotIdx::SnapshotIdxNew;
+    return true;
+  } else if (funcName == JASSTR("field_lv")) {
+    snapshot = SnapshotIdx::SnapshotIdxOld;
+    return true;
+  }
+  return false;
+}
+
+bool makeFieldRead(const Evaluable* evb, FieldPredicate& predicate) {
+  if (!isType<ContextFI>(evb)) {
+    return false;
+  }
+  auto& fi = static_cast<const ContextFI&>(*evb);
+  if (fi.hasLocalSymbols() || !fieldSnapshot(fi.name, predicate.snapshot)) {
+    return false;
+  }
+  if (!fi.param) {
+    return true;
+  }
+  if (!isType<Constant>(fi.param)) {
+    return false;
+  }
+  auto& path = static_cast<const Constant&>(*fi.param).value;
+  if (path.isString()) {
+    predicate.path = path.asString();
+    return true;
+  }
+  return path.isNull();
+}
+
+bool makeConstant(const Evaluable* evb, FieldPredicate& predicate) {
+  if (!isType<Constant>(evb)) {
+    return false;
+  }
+  auto& value = static_cast<const Constant&>(*evb).value;
+  if (!value.isNumber() && !value.isString() && !value.isBool()) {
+    return false;
+  }
+  predicate.constant = value;
+  return true;
+}
+
+bool makePredicate(const Evaluable* evb, FieldPredicate& predicate) {
+  if (isType<ComparisonOperator>(evb)) {
+    auto& op = static_cast<const ComparisonOperator&>(*evb);
+    if (op.hasLocalSymbols() || op.params.size() != 2) {
+      return false;
+    }
+    predicate.kind = FieldPredicate::Kind::compare;
+    predicate.op = op.type;
+    auto& first = op.params.front();
+    auto& second = op.params.back();
+    if (makeFieldRead(first.get(), predicate) &&
+        makeConstant(second.get(), predicate)) {
+      predicate.fieldFirst = true;
+      return true;
+    }
+    if (makeFieldRead(second.get(), predicate) &&
+        makeConstant(first.get(), predicate)) {
+      predicate.fieldFirst = false;
+      return true;
+    }
+    return false;
+  } else if (isType<LogicalOperator>(evb)) {
+    auto& op = static_cast<const LogicalOperator&>(*evb);
+    if (op.hasLocalSymbols()) {
+      return false;
+    }
+    switch (op.type) {
+      case lot::logical_and:
+        predicate.kind = FieldPredicate::Kind::all;
+        break;
+      case lot::logical_or:
+        predicate.kind = FieldPredicate::Kind::any;
+        break;
+      case lot::logical_not:
+        predicate.kind = FieldPredicate::Kind::negate;
+        break;
+      default:
+        return false;
+    }
+    if (predicate.kind == FieldPredicate::Kind::negate
+            ? op.params.size() != 1
+            : op.params.size() < 2) {
+      return false;
+    }
+    for (auto& param : op.params) {
+      predicate.operands.emplace_back();
+      if (!makePredicate(param.get(), predicate.operands.back())) {
+        return false;
+      }
+    }
+    return true;
+  }
+  return false;
+}
+
+bool predicateAlgorithm(lsaot type) {
+  switch (type) {
+    case lsaot::any_of:
+    case lsaot::all_of:
+    case lsaot::none_of:
+    case lsaot::count_if:
+    case lsaot::filter_if:
+      return true;
+    default:
+      return false;
+  }
+}
+
+size_t compileAll(const EvaluablePtr& evb) {
+  size_t compiled = 0;
+  if (isType<ListAlgorithm>(evb)) {
+    auto& algorithm = static_cast<ListAlgorithm&>(*evb);
+    FieldPredicate predicate;
+    if (predicateAlgorithm(algorithm.type) &&
+        makePredicate(algorithm.cond.get(), predicate)) {
+      algorithm.fieldPredicate =
+          std::make_shared<const FieldPredicate>(std::move(predicate));
+      ++compiled;
+    }
+  }
+  forEachChild(evb.get(), [&compiled](EvaluablePtr& child, ChildScope) {
+    compiled += compileAll(child);
+  });
+  return compiled;
+}
+
+}  // namespace
+
+bool FieldPredicate::test(const Var& item, bool& result) const {
+  switch (kind) {
+    case Kind::compare: {
+      Var field;
+      if (!HistoricalEvalContext::itemField(item, path, snapshot, field)) {
+        return false;
+      }
+      auto& first = fieldFirst ? field : constant;
+      auto& second = fieldFirst ? constant : field;
+      if (first.isNumber() && second.isNumber()) {
+        result = compareValues(op, first.asNumber(), second.asNumber());
+      } else if (first.isString() && second.isString()) {
+        result = compareValues(op, first.asString(), second.asString());
+      } else if (first.isBool() && second.isBool() &&
+                 (op == cot::eq || op == cot::neq)) {
+        result = compareValues(op, first.asBool(), second.asBool());
+      } else {
+        return false;
+      }
+      return true;
+    }
+    case Kind::negate:
+      if (!operands.front().test(item, result)) {
+        return false;
+      }
+      result = !result;
+      return true;
+    default: {
+      // operands are pure, then those after the deciding one are skipped
+      // as evaluator does
+      auto untilVal = kind == Kind::any;
+      for (auto& operand : operands) {
+        if (!operand.test(item, result)) {
+          return false;
+        }
+        if (result == untilVal) {
+          return true;
+        }
+      }
+      result = !untilVal;
+      return true;
+    }
+  }
+}
+
+bool FieldPredicate::appliesTo(const EvalContextIF& context) {
+  return typeid(context) == typeid(HistoricalEvalContext);
+}
+
+size_t compileFieldPredicates(const EvaluablePtr& root,
+                              const EvalContextPtr&) {
+  if (!root) {
+    return 0;
+  }
+  return compileAll(root);
+}
+
+}  // namespace jas
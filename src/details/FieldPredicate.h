@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+
+#include "jas/EvalContextIF.h"
+#include "jas/EvaluableClasses.h"
+#include "jas/HistoricalEvalContext.h"
+
+namespace jas {
+
+/// Condition of list algorithms made of comparisons between fields of the
+/// item and constants, combined by logical operators. It is tested on items
+/// natively, without frames, sub contexts and function invocations
+struct FieldPredicate {
+  enum class Kind { compare, all, any, negate };
+  using SnapshotIdx = HistoricalEvalContext::SnapshotIdx;
+
+  /// Returns false if the result cannot be decided natively, such as on
+  /// operands of different types, then the condition must be evaluated as is
+  bool test(const Var& item, bool& result) const;
+  /// Sub contexts of `context` read item fields as the predicate does
+  static bool appliesTo(const EvalContextIF& context);
+
+  Kind kind = Kind::compare;
+  cot op = cot::invalid;
+  String path;
+  SnapshotIdx snapshot = SnapshotIdx::SnapshotIdxNew;
+  Var constant;
+  bool fieldFirst = true;
+  std::vector<FieldPredicate> operands;
+};
+
+/// Annotates list algorithms whose conditions are field predicates. Returns
+/// number of annotated algorithms
+size_t compileFieldPredicates(const EvaluablePtr& root,
+                              const EvalContextPtr& context);
+
+}  // namespace jas
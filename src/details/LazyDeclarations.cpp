@@ -0,0 +1,127 @@
+#include "LazyDeclarations.h"
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+#include "SideEffects.h"
+#include "jas/HistoricalEvalContext.h"
+
+namespace jas {
+
+namespace {
+
+class LazyDeclarationsMarker {
+ public:
+  LazyDeclarationsMarker(const EvalContextPtr& context) : context_(context) {}
+
+  size_t run(const EvaluablePtr& root) {
+    collectModifiedVariables(root.get(), modified_);
+    analyze(root);
+    return deferred_;
+  }
+
+ private:
+  bool analyze(const EvaluablePtr& evb) {
+    SideEffectFree sideEffectFree{context_};
+    evb->accept(&sideEffectFree);
+    auto pure = sideEffectFree.pure;
+    if (isType<Variable>(evb)) {
+      pure = !modified_.count(
+          plainVariableName(static_cast<const Variable*>(evb.get())->name));
+    }
+    forEachChild(evb.get(), [&](EvaluablePtr& child, ChildScope) {
+      auto childPure = analyze(child);
+      pure = pure && childPure;
+    });
+    if (evb->useStack()) {
+      pure = deferDeclarations(evb) && pure;
+    }
+    pures_[evb.get()] = pure;
+    return pure;
+  }
+
+  /// Returns false if the evaluable updates a variable
+  bool deferDeclarations(const EvaluablePtr& evb) {
+    auto& localVariables =
+        static_cast<const UseStackEvaluable*>(evb.get())->localVariables;
+    if (!localVariables) {
+      return true;
+    }
+    // dict of a single variable declaration returns the variable itself
+    auto deferrable = !isType<MacroFI>(evb) &&
+                      !(isType<EvaluableDict>(evb) &&
+                        static_cast<const EvaluableDict*>(evb.get())
+                            ->value.empty());
+    auto updating = false;
+    for (auto& [name, var] : *localVariables) {
+      if (var.type == VariableEvalInfo::Update) {
+        updating = true;
+      } else if (deferrable && !var.onDemand && !_isGlobal(name) &&
+                 !_isStored(name) && !modified_.count(plainVariableName(name)) &&
+                 pures_[var.value.get()] &&
+                 !referencesItself(*localVariables, name)) {
+        var.onDemand = true;
+        ++deferred_;
+      }
+    }
+    return !updating;
+  }
+
+  /// Cyclic references must be reported even when the variable is never read
+  static bool referencesItself(const LocalVariables& localVariables,
+                               const String& varname) {
+    std::set<StringView> visited;
+    std::vector<const Evaluable*> pending{
+        localVariables.find(varname)->second.value.get()};
+    while (!pending.empty()) {
+      auto evb = pending.back();
+      pending.pop_back();
+      if (!evb) {
+        continue;
+      }
+      if (isType<Variable>(evb)) {
+        auto& name = static_cast<const Variable*>(evb)->name;
+        if (name == varname) {
+          return true;
+        }
+        if (auto it = localVariables.find(name);
+            it != std::end(localVariables) && visited.insert(name).second) {
+          pending.push_back(it->second.value.get());
+        }
+      }
+      forEachChild(evb, [&](EvaluablePtr& child, ChildScope) {
+        pending.push_back(child.get());
+      });
+    }
+    return false;
+  }
+
+  static bool _isGlobal(const String& name) {
+    return !name.empty() && name.front() == prefix::variable;
+  }
+
+  /// Stored variables are kept for later evaluations, even when never read
+  static bool _isStored(const String& name) {
+    auto plainName = plainVariableName(name);
+    return !plainName.empty() &&
+           plainName.front() == HistoricalEvalContext::TobeStoredVariablePrefix;
+  }
+
+  const EvalContextPtr& context_;
+  std::set<StringView> modified_;
+  std::unordered_map<const Evaluable*, bool> pures_;
+  size_t deferred_ = 0;
+};
+
+}  // namespace
+
+size_t deferPureDeclarations(const EvaluablePtr& root,
+                             const EvalContextPtr& context) {
+  if (!root) {
+    return 0;
+  }
+  return LazyDeclarationsMarker{context}.run(root);
+}
+
+}  // namespace jas
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Marks local variable declarations whose values are pure and do not depend
+/// on any modified variable as on-demand, then they are evaluated on their
+/// first read only. Returns number of deferred declarations
+size_t deferPureDeclarations(const EvaluablePtr& root,
+                             const EvalContextPtr& context);
+
+}  // namespace jas
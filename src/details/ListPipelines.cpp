@@ -0,0 +1,72 @@
+#include "ListPipelines.h"
+
+#include "SideEffects.h"
+
+__module_creating_prototype(cif);
+
+namespace jas {
+
+namespace {
+
+bool isRange(const Evaluable* evb) {
+  if (!isType<ModuleFI>(evb)) {
+    return false;
+  }
+  auto& fi = static_cast<const ModuleFI&>(*evb);
+  return !fi.hasLocalSymbols() && fi.module == mdl::cif::getModule() &&
+         fi.name == JASSTR("range");
+}
+
+class PipelineFusion {
+ public:
+  PipelineFusion(const EvalContextPtr& context) : context_(context) {}
+
+  size_t fuseAll(const EvaluablePtr& evb) {
+    size_t fused = 0;
+    if (isType<ListAlgorithm>(evb)) {
+      auto& algorithm = static_cast<ListAlgorithm&>(*evb);
+      algorithm.source = sourceOf(algorithm);
+      if (algorithm.source != ListAlgorithm::Source::list) {
+        ++fused;
+      }
+    }
+    forEachChild(evb.get(), [this, &fused](EvaluablePtr& child, ChildScope) {
+      fused += fuseAll(child);
+    });
+    return fused;
+  }
+
+ private:
+  ListAlgorithm::Source sourceOf(const ListAlgorithm& algorithm) const {
+    if (isRange(algorithm.list.get())) {
+      return ListAlgorithm::Source::range;
+    }
+    if (!isType<ListAlgorithm>(algorithm.list)) {
+      return ListAlgorithm::Source::list;
+    }
+    // conditions of the stage and its consumer are evaluated interleaved
+    // instead of one after the other
+    auto& stage = static_cast<const ListAlgorithm&>(*algorithm.list);
+    if ((stage.type == lsaot::filter_if || stage.type == lsaot::transform) &&
+        !stage.hasLocalSymbols() && stage.cond &&
+        isSideEffectFree(stage.cond.get(), context_) && algorithm.cond &&
+        isSideEffectFree(algorithm.cond.get(), context_)) {
+      return ListAlgorithm::Source::stage;
+    }
+    return ListAlgorithm::Source::list;
+  }
+
+  const EvalContextPtr& context_;
+};
+
+}  // namespace
+
+size_t fuseListPipelines(const EvaluablePtr& root,
+                         const EvalContextPtr& context) {
+  if (!root) {
+    return 0;
+  }
+  return PipelineFusion{context}.fuseAll(root);
+}
+
+}  // namespace jas
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Marks list algorithms whose list is a side-effect free filter/transform
+/// stage or a `@range` invocation to consume its items one by one, without
+/// building the intermediate list. Returns number of marked algorithms
+size_t fuseListPipelines(const EvaluablePtr& root,
+                         const EvalContextPtr& context);
+
+}  // namespace jas
@@ -0,0 +1,310 @@
+#include "MacroInliner.h"
+
+#include <map>
+#include <set>
+
+#include "SideEffects.h"
+#include "jas/BasicEvalContext.h"
+#include "jas/Exception.h"
+#include "jas/SyntaxEvaluatorImpl.h"
+
+namespace jas {
+
+using std::move;
+
+namespace {
+
+/// Bigger bodies are cheaper to share than to copy to every call site
+constexpr size_t MaxInlinedBodySize = 64;
+
+size_t sizeOf(const Evaluable* evb) {
+  size_t size = 1;
+  forEachChild(evb, [&size](EvaluablePtr& child, ChildScope) {
+    size += sizeOf(child.get());
+  });
+  return size;
+}
+
+bool readsVariables(const Evaluable* evb) {
+  auto reads = isType<Variable>(evb);
+  forEachChild(evb, [&reads](EvaluablePtr& child, ChildScope) {
+    reads = reads || readsVariables(child.get());
+  });
+  return reads;
+}
+
+/// Arguments of an invocation when they are known at translate time
+bool argumentsOf(const MacroFI& fi, Evaluables& args) {
+  if (!fi.param) {
+    return true;
+  }
+  if (isType<EvaluableList>(fi.param)) {
+    args = static_cast<const EvaluableList*>(fi.param.get())->value;
+    return true;
+  }
+  if (isType<Constant>(fi.param)) {
+    auto& value = static_cast<const Constant*>(fi.param.get())->value;
+    if (value.isList()) {
+      for (auto& item : value.asList()) {
+        args.push_back(makeConst(nullptr, item));
+      }
+      return true;
+    }
+  }
+  return false;
+}
+
+class MacroInliner {
+ public:
+  MacroInliner(const EvalContextPtr& context) : context_(context) {}
+
+  size_t run(const EvaluablePtr& root) {
+    forEachChild(root.get(), [this](EvaluablePtr& child, ChildScope) {
+      process(child);
+    });
+    return inlined_;
+  }
+
+ private:
+  struct Invocation {
+    Evaluables args;
+    std::map<size_t, String> bindings;
+  };
+
+  void process(EvaluablePtr& slot) {
+    if (isType<MacroFI>(slot)) {
+      if (auto inlined = inlineInvocation(static_cast<const MacroFI&>(*slot))) {
+        slot = move(inlined);
+        ++inlined_;
+        // body might be an invocation of another macro
+        process(slot);
+        return;
+      }
+    }
+    forEachChild(slot.get(), [this](EvaluablePtr& child, ChildScope) {
+      process(child);
+    });
+  }
+
+  EvaluablePtr inlineInvocation(const MacroFI& fi) {
+    if (fi.hasLocalSymbols() || !fi.macro || !fi.macro->evb) {
+      return {};
+    }
+    auto& body = fi.macro->evb;
+    Invocation invocation;
+    if (!argumentsOf(fi, invocation.args) || isRecursive(fi.macro.get()) ||
+        sizeOf(body.get()) > MaxInlinedBodySize ||
+        !independentOfInvocationContext(body.get(),
+                                        !invocation.args.empty())) {
+      return {};
+    }
+
+    auto bindable = body->useStack() && !isEmptyValuedDict(body.get());
+    for (auto& arg : invocation.args) {
+      if (isType<Constant>(arg)) {
+        continue;
+      }
+      // arguments are evaluated on demand instead of before the body
+      if (!bindable || !isSideEffectFree(arg.get(), context_) ||
+          (readsVariables(arg.get()) &&
+           (!isSideEffectFree(body.get(), context_) ||
+            static_cast<const UseStackEvaluable*>(body.get())
+                ->hasLocalVariables()))) {
+        return {};
+      }
+    }
+
+    auto inlined = EvaluableCloner::clone(body, fi.parent);
+    substitute(inlined, invocation);
+    if (!invocation.bindings.empty()) {
+      auto& host = static_cast<UseStackEvaluable&>(*inlined);
+      if (!host.localVariables) {
+        host.localVariables = makeTreeShared<LocalVariables>();
+      }
+      for (auto& [idx, varname] : invocation.bindings) {
+        auto value = EvaluableCloner::clone(invocation.args[idx], &host);
+        host.localVariables->emplace(
+            varname,
+            VariableEvalInfo{move(value), VariableEvalInfo::Declaration, true});
+      }
+    }
+    fold(inlined);
+    return inlined;
+  }
+
+  static bool isEmptyValuedDict(const Evaluable* evb) {
+    // dict of a single variable declaration returns the variable itself
+    return isType<EvaluableDict>(evb) &&
+           static_cast<const EvaluableDict*>(evb)->value.empty();
+  }
+
+  bool isRecursive(const Macro* macro) {
+    if (auto it = recursive_.find(macro); it != std::end(recursive_)) {
+      return it->second;
+    }
+    std::set<const Macro*> visited;
+    return recursive_[macro] = invokes(macro->evb.get(), macro, visited);
+  }
+
+  static bool invokes(const Evaluable* evb, const Macro* macro,
+                      std::set<const Macro*>& visited) {
+    if (isType<MacroFI>(evb)) {
+      auto callee = static_cast<const MacroFI*>(evb)->macro.get();
+      if (callee == macro) {
+        return true;
+      }
+      if (callee && visited.insert(callee).second &&
+          invokes(callee->evb.get(), macro, visited)) {
+        return true;
+      }
+    }
+    auto found = false;
+    forEachChild(evb, [&](EvaluablePtr& child, ChildScope) {
+      found = found || invokes(child.get(), macro, visited);
+    });
+    return found;
+  }
+
+  /// Body must not observe the arguments of the invocation's context except
+  /// through `$N`, `$#` and `$*` of its own scope
+  static bool independentOfInvocationContext(const Evaluable* evb,
+                                             bool hasArgs,
+                                             bool inherited = true) {
+    if (isType<ContextFI>(evb)) {
+      return false;
+    }
+    if (isType<ContextArgument>(evb) || isType<ContextArgumentsInfo>(evb)) {
+      return hasArgs && inherited;
+    }
+    if (isType<MacroFI>(evb)) {
+      // invocation without arguments falls back to the arguments of caller
+      Evaluables args;
+      if (!argumentsOf(static_cast<const MacroFI&>(*evb), args) ||
+          args.empty()) {
+        return false;
+      }
+    }
+    auto independent = true;
+    forEachChild(evb, [&](EvaluablePtr& child, ChildScope scope) {
+      if (!independent) {
+        return;
+      }
+      if (scope == ChildScope::Inherited) {
+        independent = independentOfInvocationContext(child.get(), hasArgs,
+                                                      inherited);
+      } else if (!isSealedCondition(evb, child)) {
+        independent =
+            independentOfInvocationContext(child.get(), hasArgs, false);
+      }
+    });
+    return independent;
+  }
+
+  /// Condition evaluated on its own stack frame always receives the item
+  static bool isSealedCondition(const Evaluable* parent,
+                                const EvaluablePtr& child) {
+    return isType<ListAlgorithm>(parent) &&
+           static_cast<const ListAlgorithm*>(parent)->cond == child &&
+           child->useStack();
+  }
+
+  void substitute(EvaluablePtr& slot, Invocation& invocation) {
+    if (auto replacement = argumentOf(*slot, invocation)) {
+      slot = move(replacement);
+      return;
+    }
+    forEachChild(slot.get(), [&](EvaluablePtr& child, ChildScope scope) {
+      if (scope == ChildScope::Inherited) {
+        substitute(child, invocation);
+      }
+    });
+  }
+
+  EvaluablePtr argumentOf(const Evaluable& evb, Invocation& invocation) {
+    auto& args = invocation.args;
+    if (isType<ContextArgument>(&evb)) {
+      auto pos = static_cast<const ContextArgument&>(evb).index;
+      if (pos < 1 || static_cast<size_t>(pos) > args.size()) {
+        return makeConst(evb.parent, Var{});
+      }
+      return bindArgument(evb.parent, static_cast<size_t>(pos - 1),
+                          invocation);
+    }
+    if (isType<ContextArgumentsInfo>(&evb)) {
+      auto& arginf = static_cast<const ContextArgumentsInfo&>(evb);
+      if (arginf.type == ContextArgumentsInfo::Type::ArgCount) {
+        return makeConst(evb.parent, args.size());
+      }
+      auto list = makeEvbList(evb.parent);
+      for (size_t idx = 0; idx < args.size(); ++idx) {
+        list->value.push_back(bindArgument(list.get(), idx, invocation));
+      }
+      return list;
+    }
+    return {};
+  }
+
+  EvaluablePtr bindArgument(Evaluable* parent, size_t idx,
+                            Invocation& invocation) {
+    auto& arg = invocation.args[idx];
+    if (isType<Constant>(arg)) {
+      return EvaluableCloner::clone(arg, parent);
+    }
+    auto [itBinding, firstUse] = invocation.bindings.try_emplace(idx);
+    if (firstUse) {
+      itBinding->second = strJoin(JASSTR("~arg"), bindingIdx_++);
+    }
+    return makeVariable(parent, itBinding->second);
+  }
+
+  void fold(EvaluablePtr& slot) {
+    forEachChild(slot.get(), [this](EvaluablePtr& child, ChildScope) {
+      fold(child);
+    });
+    if (!isFoldable(slot.get())) {
+      return;
+    }
+    try {
+      SyntaxEvaluatorImpl evaluator;
+      auto value =
+          evaluator.evaluate(slot, std::make_shared<BasicEvalContext>());
+      slot = makeConst(slot->parent, move(value));
+    } catch (const Exception&) {
+      // let the error be reported on evaluation
+    }
+  }
+
+  static bool isFoldable(const Evaluable* evb) {
+    if (!isType<ArithmaticalOperator>(evb) && !isType<LogicalOperator>(evb) &&
+        !isType<ComparisonOperator>(evb) &&
+        !isType<ObjectPropertyQuery>(evb)) {
+      return false;
+    }
+    if (evb->useStack() &&
+        static_cast<const UseStackEvaluable*>(evb)->hasLocalSymbols()) {
+      return false;
+    }
+    auto constant = true;
+    forEachChild(evb, [&constant](EvaluablePtr& child, ChildScope) {
+      constant = constant && isType<Constant>(child);
+    });
+    return constant;
+  }
+
+  const EvalContextPtr& context_;
+  std::map<const Macro*, bool> recursive_;
+  size_t bindingIdx_ = 0;
+  size_t inlined_ = 0;
+};
+
+}  // namespace
+
+size_t inlineMacroInvocations(const EvaluablePtr& root,
+                              const EvalContextPtr& context) {
+  if (!root) {
+    return 0;
+  }
+  return MacroInliner{context}.run(root);
+}
+
+}  // namespace jas
@@ -0,0 +1,14 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Replaces invocations of small non-recursive macros by copies of their
+/// bodies, in which the macro arguments are substituted and constant
+/// operations are folded. Returns number of inlined invocations
+size_t inlineMacroInvocations(const EvaluablePtr& root,
+                              const EvalContextPtr& context);
+
+}  // namespace jas
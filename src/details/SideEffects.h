@@ -0,0 +1,113 @@
+#pragma once
+
+#include <set>
+
+#include "EvaluableTraversal.h"
+#include "jas/EvalContextIF.h"
+#include "jas/FunctionModule.h"
+#include "jas/Keywords.h"
+
+namespace jas {
+
+/// Tells whether an evaluable, children excluded, is free of side effects
+struct SideEffectFree : public EvaluatorIF {
+  SideEffectFree(const EvalContextPtr& context) : context(context) {}
+
+  void eval(const Constant&) override { pure = true; }
+  void eval(const EvaluableDict&) override { pure = true; }
+  void eval(const EvaluableList&) override { pure = true; }
+  void eval(const ArithmaticalOperator&) override { pure = true; }
+  void eval(const ArthmSelfAssignOperator&) override { pure = false; }
+  void eval(const LogicalOperator&) override { pure = true; }
+  void eval(const ComparisonOperator&) override { pure = true; }
+  void eval(const ListAlgorithm&) override { pure = true; }
+  void eval(const ModuleFI& fi) override {
+    pure = fi.module->functionIsPure(fi.name);
+  }
+  // macro arguments are set on the invocation's context
+  void eval(const MacroFI&) override { pure = false; }
+  void eval(const ContextFI& fi) override {
+    pure = context && context->functionIsPure(fi.name);
+  }
+  void eval(const EvaluatorFI&) override { pure = true; }
+  void eval(const ObjectPropertyQuery&) override { pure = true; }
+  void eval(const Variable&) override { pure = true; }
+  void eval(const ContextArgument&) override { pure = true; }
+  void eval(const ContextArgumentsInfo&) override { pure = true; }
+
+  const EvalContextPtr& context;
+  bool pure = false;
+};
+
+inline bool updatesVariables(const Evaluable* evb) {
+  if (evb->useStack()) {
+    auto& localVariables =
+        static_cast<const UseStackEvaluable*>(evb)->localVariables;
+    if (localVariables) {
+      for (auto& [name, var] : *localVariables) {
+        if (var.type == VariableEvalInfo::Update) {
+          return true;
+        }
+      }
+    }
+  }
+  return false;
+}
+
+/// Whole subtree of evaluable is free of side effects
+inline bool isSideEffectFree(const Evaluable* evb,
+                             const EvalContextPtr& context) {
+  SideEffectFree sideEffectFree{context};
+  evb->accept(&sideEffectFree);
+  auto pure = sideEffectFree.pure && !updatesVariables(evb);
+  forEachChild(evb, [&](EvaluablePtr& child, ChildScope) {
+    pure = pure && isSideEffectFree(child.get(), context);
+  });
+  return pure;
+}
+
+/// Global variables(`$$name`) share the same name with local ones
+inline StringView plainVariableName(const String& name) {
+  auto pos = name.find_first_not_of(prefix::variable);
+  return pos != String::npos ? StringView{name}.substr(pos) : StringView{};
+}
+
+/// Names of variables modified by updates(`$+name`), self-assign operators or
+/// functions having side effects on their arguments
+inline void collectModifiedVariables(const Evaluable* evb,
+                                     std::set<StringView>& modified,
+                                     bool modifying = false) {
+  if (modifying && isType<Variable>(evb)) {
+    modified.insert(
+        plainVariableName(static_cast<const Variable*>(evb)->name));
+    return;
+  }
+  if (evb->useStack()) {
+    auto& localVariables =
+        static_cast<const UseStackEvaluable*>(evb)->localVariables;
+    if (localVariables) {
+      for (auto& [name, var] : *localVariables) {
+        if (var.type == VariableEvalInfo::Update) {
+          modified.insert(plainVariableName(name));
+        }
+      }
+    }
+  }
+
+  bool modifyingChildren = modifying;
+  if (isType<ModuleFI>(evb)) {
+    auto& fi = static_cast<const ModuleFI&>(*evb);
+    modifyingChildren = modifying || !fi.module->functionIsPure(fi.name);
+  }
+  auto selfAssign = isType<ArthmSelfAssignOperator>(evb)
+                        ? static_cast<const ArthmSelfAssignOperator*>(evb)
+                        : nullptr;
+  forEachChild(evb, [&](EvaluablePtr& child, ChildScope) {
+    auto assigned = selfAssign && !selfAssign->params.empty() &&
+                    child == selfAssign->params.front();
+    collectModifiedVariables(child.get(), modified,
+                             modifyingChildren || assigned);
+  });
+}
+
+}  // namespace jas
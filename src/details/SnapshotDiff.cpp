@@ -0,0 +1,132 @@
+#include "SnapshotDiff.h"
+
+namespace jas {
+
+namespace {
+
+String _childPath(const String& path, const StringView& key) {
+  return path.empty() ? String{key} : strJoin(path, JASSTR("/"), key);
+}
+
+bool _same(const Var& first, const Var& second) {
+  return (first.isNull() && second.isNull()) ||
+         first.address() == second.address();
+}
+
+bool _differ(const Var& current, const Var& last) {
+  if (current.isList() || current.isDict()) {
+    // hashes stay cached on the snapshots for subtrees compared later
+    return current.hash() != last.hash() || current != last;
+  }
+  return current != last;
+}
+
+}  // namespace
+
+SnapshotDiff::SnapshotDiff(Var current, Var last) {
+  root_.current = std::move(current);
+  root_.last = std::move(last);
+}
+
+bool SnapshotDiff::of(const Var& current, const Var& last) const {
+  return _same(root_.current, current) && _same(root_.last, last);
+}
+
+bool SnapshotDiff::changed(const String& path) {
+  return changed(nodeAt(path));
+}
+
+Var SnapshotDiff::changedPaths(const String& path) {
+  Var::List changedPaths, addedPaths, removedPaths;
+  collect(nodeAt(path), path, changedPaths, addedPaths, removedPaths);
+  return Var::dict({{JASSTR("changed"), std::move(changedPaths)},
+                    {JASSTR("added"), std::move(addedPaths)},
+                    {JASSTR("removed"), std::move(removedPaths)}});
+}
+
+SnapshotDiff::Node& SnapshotDiff::nodeAt(const String& path) {
+  auto node = &root_;
+  if (!path.empty()) {
+    for (auto& key : Var::PathView{path}) {
+      node = &child(*node, key);
+    }
+  }
+  return *node;
+}
+
+SnapshotDiff::Node& SnapshotDiff::child(Node& node, const StringView& key) {
+  if (auto it = node.children.find(key); it != std::end(node.children)) {
+    return it->second;
+  }
+  auto& child = node.children[String{key}];
+  child.current = node.current.getPath(Var::PathView{key});
+  child.last = node.last.getPath(Var::PathView{key});
+  if (node.changed == false) {
+    child.changed = false;
+  }
+  return child;
+}
+
+bool SnapshotDiff::changed(Node& node) {
+  if (!node.changed) {
+    node.changed = _differ(node.current, node.last);
+  }
+  return *node.changed;
+}
+
+void SnapshotDiff::collect(Node& node, const String& path,
+                           Var::List& changedPaths, Var::List& addedPaths,
+                           Var::List& removedPaths) {
+  if (!changed(node)) {
+    return;
+  }
+  auto& current = node.current;
+  auto& last = node.last;
+  if (current.isDict() && last.isDict()) {
+    auto& currentDict = current.asDict();
+    auto& lastDict = last.asDict();
+    auto itCurrent = std::begin(currentDict);
+    auto itLast = std::begin(lastDict);
+    while (itCurrent != std::end(currentDict) ||
+           itLast != std::end(lastDict)) {
+      if (itLast == std::end(lastDict) ||
+          (itCurrent != std::end(currentDict) &&
+           itCurrent->first < itLast->first)) {
+        addedPaths.emplace_back(_childPath(path, itCurrent->first));
+        ++itCurrent;
+      } else if (itCurrent == std::end(currentDict) ||
+                 itLast->first < itCurrent->first) {
+        removedPaths.emplace_back(_childPath(path, itLast->first));
+        ++itLast;
+      } else {
+        collect(child(node, itCurrent->first),
+                _childPath(path, itCurrent->first), changedPaths, addedPaths,
+                removedPaths);
+        ++itCurrent;
+        ++itLast;
+      }
+    }
+  } else if (current.isList() && last.isList()) {
+    auto currentSize = current.size();
+    auto lastSize = last.size();
+    for (size_t i = 0; i < std::max(currentSize, lastSize); ++i) {
+      auto key = strJoin(i);
+      if (i >= lastSize) {
+        addedPaths.emplace_back(_childPath(path, key));
+      } else if (i >= currentSize) {
+        removedPaths.emplace_back(_childPath(path, key));
+      } else {
+        collect(child(node, key), _childPath(path, key), changedPaths,
+                addedPaths, removedPaths);
+      }
+    }
+  } else if (last.isNull()) {
+    addedPaths.emplace_back(path);
+  } else if (current.isNull()) {
+    removedPaths.emplace_back(path);
+  } else {
+    changedPaths.emplace_back(path);
+  }
+}
+
+}  // namespace jas
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <optional>
+
+#include "jas/Var.h"
+
+namespace jas {
+
+/// Differences between the current and last snapshots of a context. Subtrees
+/// are compared once, when a path in them is first asked for, and those of
+/// an unchanged subtree are known unchanged without being compared
+class SnapshotDiff {
+ public:
+  SnapshotDiff(Var current, Var last);
+
+  /// The diff was built for these snapshots
+  bool of(const Var& current, const Var& last) const;
+  /// Value at `path` differs between the snapshots
+  bool changed(const String& path);
+  /// Paths under `path` whose values were changed, added or removed, as
+  /// `{"changed": [...], "added": [...], "removed": [...]}`
+  Var changedPaths(const String& path);
+
+ private:
+  struct Node {
+    Var current;
+    Var last;
+    std::optional<bool> changed;
+    std::map<String, Node, std::less<>> children;
+  };
+
+  Node& nodeAt(const String& path);
+  Node& child(Node& node, const StringView& key);
+  bool changed(Node& node);
+  void collect(Node& node, const String& path, Var::List& changedPaths,
+               Var::List& addedPaths, Var::List& removedPaths);
+
+  Node root_;
+};
+
+}  // namespace jas
@@ -0,0 +1,115 @@
+#include "SnapshotReads.h"
+
+#include "FieldPredicate.h"
+#include "SideEffects.h"
+
+namespace jas {
+
+namespace {
+
+enum class ReadOf { current, last, both };
+
+class SnapshotReadsCollector {
+ public:
+  SnapshotReadsCollector(SnapshotReads& reads) : reads_(reads) {}
+
+  /// Items of list algorithms are the arguments of their conditions, and
+  /// the data that field functions read there unless they are null
+  bool collect(const Evaluable* evb, bool onItem) {
+    if (isType<ContextFI>(evb)) {
+      if (!collectFieldRead(static_cast<const ContextFI&>(*evb))) {
+        return false;
+      }
+    } else if (isType<ContextArgument>(evb)) {
+      auto index = static_cast<const ContextArgument&>(*evb).index;
+      if (!onItem && (index == 1 || index == 2)) {
+        add(String{}, index == 1 ? ReadOf::current : ReadOf::last);
+      }
+    } else if (isType<ContextArgumentsInfo>(evb)) {
+      if (!onItem) {
+        add(String{}, ReadOf::both);
+      }
+    }
+    const EvaluablePtr* itemScoped = nullptr;
+    if (isType<ListAlgorithm>(evb)) {
+      itemScoped = &static_cast<const ListAlgorithm&>(*evb).cond;
+    }
+    auto known = true;
+    forEachChild(evb, [&](EvaluablePtr& child, ChildScope) {
+      known = known && collect(child.get(), onItem || &child == itemScoped);
+    });
+    return known;
+  }
+
+ private:
+  bool collectFieldRead(const ContextFI& fi) {
+    if (fi.param && !isType<Constant>(fi.param)) {
+      return false;
+    }
+    auto param = fi.param ? static_cast<const Constant&>(*fi.param).value
+                          : Var{};
+    if (fi.name == JASSTR("field")) {
+      return collectField(param);
+    } else if (fi.name == JASSTR("field_cv")) {
+      return collectPath(param, ReadOf::current);
+    } else if (fi.name == JASSTR("field_lv")) {
+      return collectPath(param, ReadOf::last);
+    } else if (fi.name == JASSTR("hfield")) {
+      return collectPath(param.isDict() ? param.getAt(JASSTR("path")) : param,
+                         ReadOf::both);
+    } else if (fi.name == JASSTR("hfield2arr")) {
+      return param.isList() && param.size() == 2 &&
+             collectPath(param[0], ReadOf::both);
+    } else if (fi.name == JASSTR("snchg") ||
+               fi.name == JASSTR("changed_paths")) {
+      return collectPath(param, ReadOf::both);
+    }
+    return false;
+  }
+
+  bool collectField(const Var& param) {
+    if (!param.isDict()) {
+      return collectPath(param, ReadOf::current);
+    }
+    auto snapshot = param.getAt(JASSTR("snapshot"));
+    if (snapshot.isNull() || snapshot == Var(JASSTR("cur")) ||
+        snapshot == Var(0)) {
+      return collectPath(param.getAt(JASSTR("path")), ReadOf::current);
+    } else if (snapshot == Var(JASSTR("last")) || snapshot == Var(-1)) {
+      return collectPath(param.getAt(JASSTR("path")), ReadOf::last);
+    }
+    return false;
+  }
+
+  bool collectPath(const Var& path, ReadOf readOf) {
+    if (!path.isString() && !path.isNull()) {
+      return false;
+    }
+    add(path.getString(), readOf);
+    return true;
+  }
+
+  void add(const String& path, ReadOf readOf) {
+    if (readOf != ReadOf::last) {
+      reads_.current.insert(path);
+    }
+    if (readOf != ReadOf::current) {
+      reads_.last.insert(path);
+    }
+  }
+
+  SnapshotReads& reads_;
+};
+
+}  // namespace
+
+bool collectSnapshotReads(const EvaluablePtr& root,
+                          const EvalContextPtr& context, SnapshotReads& reads) {
+  if (!root || !context || !FieldPredicate::appliesTo(*context) ||
+      !isSideEffectFree(root.get(), context)) {
+    return false;
+  }
+  return SnapshotReadsCollector{reads}.collect(root.get(), false);
+}
+
+}  // namespace jas
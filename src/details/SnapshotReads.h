@@ -0,0 +1,16 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+#include "jas/HistoricalEvalContext.h"
+
+namespace jas {
+
+/// Collects the paths a rule reads in the current and last snapshots of a
+/// historical context. Returns false if they are not statically known: the
+/// rule reads paths that are not constants, older snapshots or stored
+/// results of evaluations, or it may have side effects
+bool collectSnapshotReads(const EvaluablePtr& root,
+                          const EvalContextPtr& context, SnapshotReads& reads);
+
+}  // namespace jas
@@ -0,0 +1,234 @@
+#include "TypeInference.h"
+
+#include <set>
+#include <unordered_map>
+
+#include "SideEffects.h"
+
+namespace jas {
+
+namespace {
+
+StaticType typeOf(const Var& value) {
+  if (value.isBool()) {
+    return StaticType::boolean;
+  } else if (value.isNumber()) {
+    return StaticType::number;
+  } else if (value.isString()) {
+    return StaticType::string;
+  } else if (value.isList()) {
+    return StaticType::list;
+  } else if (value.isDict()) {
+    return StaticType::dict;
+  }
+  return StaticType::unknown;
+}
+
+/// Types of operands that evaluator has specialized implementations for
+bool specializable(aot op, StaticType type) {
+  switch (type) {
+    case StaticType::number:
+      return true;
+    case StaticType::string:
+      return op == aot::plus;
+    default:
+      return false;
+  }
+}
+
+bool specializable(lot, StaticType type) {
+  return type == StaticType::boolean;
+}
+
+bool specializable(cot, StaticType type) {
+  return type == StaticType::number || type == StaticType::string;
+}
+
+class TypeInference : public EvaluatorIF {
+ public:
+  size_t run(const EvaluablePtr& root) {
+    collectModifiedVariables(root.get(), modified_);
+    collectMacroBodies(root.get());
+    inferAll(root.get());
+    return specialized_;
+  }
+
+  void eval(const Constant& v) override { type_ = typeOf(v.value); }
+  void eval(const EvaluableDict& v) override {
+    if (!v.value.empty()) {
+      type_ = StaticType::dict;
+    } else if (v.localVariables && v.localVariables->size() == 1) {
+      // dict of a single variable declaration returns the variable itself
+      type_ = typeOfVariable(&v, v.localVariables->begin()->first);
+    }
+  }
+  void eval(const EvaluableList&) override { type_ = StaticType::list; }
+  void eval(const ArithmaticalOperator& op) override {
+    type_ = specialize(op);
+  }
+  void eval(const ArthmSelfAssignOperator&) override {}
+  void eval(const LogicalOperator& op) override {
+    specialize(op);
+    type_ = StaticType::boolean;
+  }
+  void eval(const ComparisonOperator& op) override {
+    specialize(op);
+    type_ = StaticType::boolean;
+  }
+  void eval(const ListAlgorithm& op) override {
+    switch (op.type) {
+      case lsaot::any_of:
+      case lsaot::all_of:
+      case lsaot::none_of:
+        type_ = StaticType::boolean;
+        break;
+      case lsaot::count_if:
+        type_ = StaticType::number;
+        break;
+      case lsaot::filter_if:
+      case lsaot::transform:
+        type_ = StaticType::list;
+        break;
+      default:
+        break;
+    }
+  }
+  void eval(const ModuleFI& fi) override {
+    type_ = fi.module->functionReturnType(fi.name);
+  }
+  void eval(const MacroFI& fi) override {
+    if (fi.macro && fi.macro->evb && inferring_.insert(&fi).second) {
+      type_ = infer(fi.macro->evb.get());
+      inferring_.erase(&fi);
+    }
+  }
+  void eval(const ContextFI&) override {}
+  void eval(const EvaluatorFI& fi) override {
+    if (fi.param) {
+      type_ = infer(fi.param.get());
+    }
+  }
+  void eval(const ObjectPropertyQuery&) override {}
+  void eval(const Variable& v) override {
+    type_ = typeOfVariable(v.parent, v.name);
+  }
+  void eval(const ContextArgument&) override {}
+  void eval(const ContextArgumentsInfo& arginf) override {
+    type_ = arginf.type == ContextArgumentsInfo::Type::ArgCount
+                ? StaticType::number
+                : StaticType::list;
+  }
+
+ private:
+  void inferAll(const Evaluable* evb) {
+    infer(evb);
+    forEachChild(evb, [this](EvaluablePtr& child, ChildScope) {
+      inferAll(child.get());
+    });
+  }
+
+  void collectMacroBodies(const Evaluable* evb) {
+    if (evb->useStack()) {
+      auto& localMacros =
+          static_cast<const UseStackEvaluable*>(evb)->localMacros;
+      if (localMacros) {
+        for (auto& [name, macro] : *localMacros) {
+          macroBodies_.insert(macro->evb.get());
+        }
+      }
+    }
+    forEachChild(evb, [this](EvaluablePtr& child, ChildScope) {
+      collectMacroBodies(child.get());
+    });
+  }
+
+  StaticType infer(const Evaluable* evb) {
+    if (auto it = types_.find(evb); it != std::end(types_)) {
+      return it->second;
+    }
+    auto saved = type_;
+    type_ = StaticType::unknown;
+    evb->accept(this);
+    auto type = type_;
+    type_ = saved;
+    return types_[evb] = type;
+  }
+
+  template <class _Operator>
+  StaticType specialize(const _Operator& op) {
+    if (op.params.empty()) {
+      return StaticType::unknown;
+    }
+    auto type = infer(op.params.front().get());
+    for (auto& param : op.params) {
+      if (infer(param.get()) != type) {
+        return StaticType::unknown;
+      }
+    }
+    if (!specializable(op.type, type)) {
+      return StaticType::unknown;
+    }
+    if (op.operandType != type) {
+      const_cast<_Operator&>(op).operandType = type;
+      ++specialized_;
+    }
+    return type;
+  }
+
+  /// Variable declared in closest scope, of which value is never modified.
+  /// Variables not declared in a macro body are resolved where the macro is
+  /// invoked, their types are unknown
+  StaticType typeOfVariable(const Evaluable* scope, const String& name) {
+    if (name.empty() || name.front() == prefix::variable ||
+        modified_.count(plainVariableName(name))) {
+      return StaticType::unknown;
+    }
+    for (; scope; scope = scope->parent) {
+      if (auto declaration = declarationOf(scope, name)) {
+        auto value = declaration->value.get();
+        if (!value || !inferring_.insert(value).second) {
+          return StaticType::unknown;
+        }
+        auto type = infer(value);
+        inferring_.erase(value);
+        return type;
+      }
+      if (macroBodies_.count(scope)) {
+        break;
+      }
+    }
+    return StaticType::unknown;
+  }
+
+  static const VariableEvalInfo* declarationOf(const Evaluable* scope,
+                                               const String& name) {
+    if (!scope->useStack()) {
+      return nullptr;
+    }
+    auto& localVariables =
+        static_cast<const UseStackEvaluable*>(scope)->localVariables;
+    if (!localVariables) {
+      return nullptr;
+    }
+    auto it = localVariables->find(name);
+    return it != std::end(*localVariables) ? &it->second : nullptr;
+  }
+
+  std::set<StringView> modified_;
+  std::unordered_map<const Evaluable*, StaticType> types_;
+  std::set<const Evaluable*> inferring_;
+  std::set<const Evaluable*> macroBodies_;
+  StaticType type_ = StaticType::unknown;
+  size_t specialized_ = 0;
+};
+
+}  // namespace
+
+size_t specializeOperators(const EvaluablePtr& root, const EvalContextPtr&) {
+  if (!root) {
+    return 0;
+  }
+  return TypeInference{}.run(root);
+}
+
+}  // namespace jas
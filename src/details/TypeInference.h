@@ -0,0 +1,15 @@
+#pragma once
+
+#include "jas/EvalContextIF.h"
+#include "jas/Evaluable.h"
+
+namespace jas {
+
+/// Infers types of values from constants, function return types and variable
+/// declarations, then annotates operators whose operands are all of a same
+/// type to be evaluated without dynamic type dispatch. Returns number of
+/// annotated operators
+size_t specializeOperators(const EvaluablePtr& root,
+                           const EvalContextPtr& context);
+
+}  // namespace jas
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "jas/EvaluableClasses.h"
+
+namespace jas {
+
+/// Same semantic as comparison operators of Var
+template <class T>
+bool compareValues(cot type, const T& first, const T& second) {
+  switch (type) {
+    case cot::eq:
+      return first == second;
+    case cot::neq:
+      return !(first == second);
+    case cot::gt:
+      return second < first;
+    case cot::ge:
+      return second == first || second < first;
+    case cot::lt:
+      return first < second;
+    case cot::le:
+      return second == first || first < second;
+    default:
+      return false;
+  }
+}
+
+}  // namespace jas
@@ -0,0 +1,549 @@
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <sstream>
+
+#include "jas/ConsoleLogger.h"
+#include "jas/HistoricalEvalContext.h"
+#include "jas/JASFacade.h"
+#include "jas/Json.h"
+#include "jas/SnapshotHistory.h"
+#include "jas/SnapshotParser.h"
+#include "jas/SyntaxEvaluator.h"
+#include "jas/Translator.h"
+#include "jas/VarCodec.h"
+
+#ifdef __unix__
+#include <sys/resource.h>
+#endif
+
+using namespace jas;
+using namespace std::chrono;
+
+struct bench_case {
+  const CharType* name;
+  const CharType* rule;
+  Json data;
+  int iterations;
+};
+
+static Json make_list(int size) {
+  String items;
+  for (int i = 0; i < size; ++i) {
+    items += strJoin(i == 0 ? JASSTR("") : JASSTR(","), i);
+  }
+  return JsonTrait::parse(strJoin(JASSTR("{\"list\":["), items, JASSTR("]}")));
+}
+
+static double run(JASFacade& facade, SyntaxEvaluator::Engine engine,
+                  int iterations, Var& evaluated) {
+  facade.getEvaluator()->setEngine(engine);
+  evaluated = facade.evaluate();
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    evaluated = facade.evaluate();
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+static Json make_big_rule(int size) {
+  String items;
+  for (int i = 0; i < size; ++i) {
+    items += strJoin(i == 0 ? JASSTR("") : JASSTR(","), JASSTR("{\"$v"), i,
+                     JASSTR("\":"), i, JASSTR(",\"@plus\":[\"$v"), i,
+                     JASSTR("\",{\"@multiplies\":[2,\"@field:x\"]}]}"));
+  }
+  return JsonTrait::parse(strJoin(JASSTR("["), items, JASSTR("]")));
+}
+
+/// Translating then releasing a rule, as when policies are swapped
+static double translate(JASFacade& facade, const Json& rule, bool arena,
+                        int iterations) {
+  Translator::Optimizations opts;
+  opts.arenaAllocation = arena;
+  facade.getParser()->setOptimizations(opts);
+  auto context = std::make_shared<HistoricalEvalContext>(nullptr, Json{});
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    facade.getParser()->translate(context, Var(rule));
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+static Json make_records(int size) {
+  String items;
+  for (int i = 0; i < size; ++i) {
+    items += strJoin(i == 0 ? JASSTR("") : JASSTR(","), JASSTR("{\"name\":\"n"),
+                     i % 10, JASSTR("\",\"v\":"), i, JASSTR("}"));
+  }
+  return JsonTrait::parse(strJoin(JASSTR("{\"list\":["), items, JASSTR("]}")));
+}
+
+/// Evaluating a list algorithm condition generically or as field predicate
+static double predicate(const Json& data, bool native, int iterations,
+                        Var& evaluated) {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.fieldPredicates = native;
+  facade.getParser()->setOptimizations(opts);
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, data));
+  facade.setExpression(JsonTrait::parse(
+      JASSTR(R"({"@count_if":{"@list":"@field:list","@cond":{"@and":[)"
+             R"({"@eq":["@field:name","n3"]},{"@gt":["@field:v",100]}]}}})")));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, iterations,
+             evaluated);
+}
+
+/// Chained list algorithms building their intermediate lists or fused, the
+/// fused ones stop at the first match
+static double pipeline(bool fused, int iterations, Var& evaluated) {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.fuseListPipelines = fused;
+  facade.getParser()->setOptimizations(opts);
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, Json{}));
+  facade.setExpression(JsonTrait::parse(JASSTR(
+      R"({"@any_of":{"@list":{"@filter_if":{"@list":{"@transform":{)"
+      R"("@list":{"@range":[0,2000]},"@op":{"@multiplies":["@field",3]}}},)"
+      R"("@cond":{"@eq":[{"@modulus":["@field",2]},0]}}},)"
+      R"("@cond":{"@gt":["@field",300]}}})")));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, iterations,
+             evaluated);
+}
+
+static long peak_memory_kb() {
+#ifdef __unix__
+  rusage usage{};
+  getrusage(RUSAGE_SELF, &usage);
+  return usage.ru_maxrss;
+#else
+  return 0;
+#endif
+}
+
+/// Fused counting over a range with a condition of several operators, whose
+/// operands are reused for each item. Returns the time per item
+static double long_loop(int size, Var& evaluated) {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.fuseListPipelines = true;
+  facade.getParser()->setOptimizations(opts);
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, Json{}));
+  facade.setExpression(JsonTrait::parse(strJoin(
+      JASSTR(R"({"@count_if":{"@list":{"@range":[0,)"), size,
+      JASSTR(R"(]},"@cond":{"@and":[{"@gt":["$1",10]},{"@lt":["$1",)"), size,
+      JASSTR("]}]}}}"))));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, 1, evaluated) /
+         size;
+}
+
+/// Sorting records by comparing them with a predicate or by their keys
+static double sort(const Json& data, bool byKey, int iterations,
+                   Var& evaluated) {
+  JASFacade facade;
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, data));
+  facade.setExpression(JsonTrait::parse(
+      byKey ? JASSTR(R"({"@alg.sort_by":["@field:list","$1[name]"]})")
+            : JASSTR(R"({"@alg.sort":["@field:list",)"
+                     R"({"@lt":["$1[name]","$2[name]"]}]})")));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, iterations,
+             evaluated);
+}
+
+/// Appending an item to a large list held by a variable, building the sum
+/// aside or appending to the unshared variable in place
+static double append(bool selfAssign, int size, int iterations,
+                     Var& evaluated) {
+  JASFacade facade;
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, Json{}));
+  facade.setExpression(JsonTrait::parse(strJoin(
+      JASSTR(R"({"$big":{"@range":[0,)"), size, JASSTR(R"(]},"@list.len":{")"),
+      selfAssign ? JASSTR("@s_plus") : JASSTR("@plus"),
+      JASSTR(R"(":["$big",[-1]]}})"))));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, iterations,
+             evaluated);
+}
+
+/// Checking changes of many fields of large snapshots by comparing them or
+/// by looking them up in the snapshot diff
+static double changes(bool diff, int iterations, Var& evaluated) {
+  auto current = make_records(2000);
+  auto last = make_records(2000);
+  String rule;
+  for (int i = 0; i < 200; ++i) {
+    auto path = strJoin(JASSTR("list/"), i * 10);
+    rule += strJoin(i == 0 ? JASSTR("[") : JASSTR(","),
+                    diff ? strJoin(JASSTR("{\"@snchg\":\""), path, JASSTR("\"}"))
+                         : strJoin(JASSTR("{\"@neq\":[\"@field_cv:"), path,
+                                   JASSTR("\",\"@field_lv:"), path,
+                                   JASSTR("\"]}")));
+  }
+  rule += strJoin(JASSTR(",{\"@snchg\":\"\"}]"));
+  JASFacade facade;
+  facade.setContext(std::make_shared<HistoricalEvalContext>(
+      nullptr, Var(current), Var(last)));
+  facade.setExpression(JsonTrait::parse(rule));
+  return run(facade, SyntaxEvaluator::Engine::Interpreter, iterations,
+             evaluated);
+}
+
+/// Persisting stored results of many contexts after each evaluation that
+/// changes a few of them, by rewriting all or by appending the changed ones
+static double persist(bool append, int iterations, size_t& written) {
+  EvalResultStore store;
+  std::vector<EvalResultStore::ContextKey> keys;
+  for (int i = 0; i < 2000; ++i) {
+    keys.push_back(store.keyOf(strJoin(JASSTR("/list.transform/"), i)));
+    store.put(keys.back(), JASSTR(".v"), Var(Var::Int{i}));
+  }
+  std::basic_ostringstream<CharType> initial;
+  store.writeLog(initial);
+  written = 0;
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    for (int k = 0; k < 10; ++k) {
+      store.put(keys[(i * 10 + k) % keys.size()], JASSTR(".v"),
+                Var(Var::Int{-i}));
+    }
+    std::basic_ostringstream<CharType> ostrm;
+    if (append) {
+      store.appendLog(ostrm);
+    } else {
+      ostrm << JsonTrait::dump(store.toVar().toJson());
+    }
+    written += ostrm.str().size();
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+static void collect_nodes(const Var& value, std::set<uint64_t>& nodes) {
+  if (nodes.insert(value.address()).second) {
+    if (value.isList()) {
+      for (auto& item : value.asList()) {
+        collect_nodes(item, nodes);
+      }
+    } else if (value.isDict()) {
+      for (auto& [key, item] : value.asDict()) {
+        collect_nodes(item, nodes);
+      }
+    }
+  }
+}
+
+/// Keeping a history of large snapshots that change in one record each, as
+/// the distinct values it holds, against holding every snapshot whole
+static double history(int depth, size_t& heldNodes, size_t& wholeNodes) {
+  auto records = make_records(2000);
+  SnapshotHistory snapshots(depth);
+  auto start = steady_clock::now();
+  for (int i = 0; i < depth; ++i) {
+    auto snapshot = Var(records);
+    snapshot[JASSTR("list")][i][JASSTR("v")] = Var(Var::Int{-i});
+    snapshots.push(snapshot);
+  }
+  auto elapsed =
+      duration<double, std::micro>(steady_clock::now() - start).count() /
+      depth;
+  std::set<uint64_t> nodes;
+  for (size_t age = 0; age < snapshots.size(); ++age) {
+    collect_nodes(snapshots.at(age), nodes);
+  }
+  heldNodes = nodes.size();
+  nodes.clear();
+  collect_nodes(snapshots.at(0), nodes);
+  wholeNodes = nodes.size() * snapshots.size();
+  return elapsed;
+}
+
+/// Evaluating a rule on snapshots that do not change at the paths it reads,
+/// each time or by reusing its last result
+static double unchanged(bool reuse, int iterations, Var& evaluated) {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.reuseUnchangedResults = reuse;
+  facade.getParser()->setOptimizations(opts);
+  // snapshots are parsed for each evaluation, nothing is cached on them
+  std::vector<Var> snapshots;
+  for (int i = 0; i <= iterations; ++i) {
+    snapshots.emplace_back(make_records(1000));
+  }
+  auto stored = std::make_shared<HistoricalEvalContext::EvaluatedVariables>();
+  auto evaluate = [&](int i) {
+    auto context = std::make_shared<HistoricalEvalContext>(
+        nullptr, snapshots[i], snapshots[i]);
+    context->setLastEvalResult(stored);
+    facade.setContext(context);
+    return facade.evaluate();
+  };
+  facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, Json{}));
+  facade.setExpression(JsonTrait::parse(
+      JASSTR(R"({"@count_if":{"@list":"@field:list","@cond":{"@and":[)"
+             R"({"@eq":["@field:name","n3"]},{"@gt":["@field:v",100]}]}}})")));
+  evaluated = evaluate(0);
+  auto start = steady_clock::now();
+  for (int i = 1; i <= iterations; ++i) {
+    evaluated = evaluate(i);
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+/// Loading a large snapshot json text for a rule reading a few of its paths,
+/// parsed whole or at those paths only, then evaluating the rule
+static double ingest(bool projected, int iterations, Var& evaluated) {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.projectSnapshots = projected;
+  facade.getParser()->setOptimizations(opts);
+  facade.setContext(std::make_shared<HistoricalEvalContext>());
+  facade.setExpression(JsonTrait::parse(
+      JASSTR(R"({"ok":{"@eq":["@field:status/state","up"]},)"
+             R"("first":"@field:list/0/v"})")));
+  auto reads = facade.getParser()->snapshotReads();
+  auto projection =
+      reads ? SnapshotProjection{reads->current} : SnapshotProjection{};
+  auto data = Var(make_records(50000));
+  data[JASSTR("status")] = Var::dict({{JASSTR("state"), Var(JASSTR("up"))}});
+  auto text = data.dump();
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    auto snapshot = projected ? parseSnapshot(text, projection)
+                              : Var(JsonTrait::parse(text));
+    facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr,
+                                                              snapshot));
+    evaluated = facade.evaluate();
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+/// Evaluating a rule reading a few paths of a large json an embedder already
+/// holds, converted whole or viewed
+static double view(bool viewed, int iterations, Var& evaluated) {
+  JASFacade facade;
+  facade.setContext(std::make_shared<HistoricalEvalContext>());
+  facade.setExpression(JsonTrait::parse(
+      JASSTR(R"({"ok":{"@eq":["@field:status/state","up"]},)"
+             R"("first":"@field:list/0/v"})")));
+  auto data = Var(make_records(50000));
+  data[JASSTR("status")] = Var::dict({{JASSTR("state"), Var(JASSTR("up"))}});
+  auto json = std::make_shared<const Json>(data.toJson());
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    facade.setContext(viewed ? HistoricalEvalContext::make(nullptr, json)
+                             : HistoricalEvalContext::make(nullptr, *json));
+    evaluated = facade.evaluate();
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+/// Re-evaluating a rule of dynamic paths on archived snapshot files, read and
+/// parsed whole or mapped and decoded on demand
+static double archived(bool mapped, int files, Var& evaluated) {
+  namespace fs = std::filesystem;
+  auto dir = fs::temp_directory_path() / "jas_bench_snapshots";
+  fs::create_directories(dir);
+  auto data = Var(make_records(20000));
+  data[JASSTR("status")] = Var::dict({{JASSTR("state"), Var(JASSTR("up"))}});
+  auto text = data.dump();
+  for (int i = 0; i < files; ++i) {
+    std::basic_ofstream<CharType>{dir / std::to_string(i)} << text;
+  }
+  JASFacade facade;
+  facade.setContext(std::make_shared<HistoricalEvalContext>());
+  facade.setExpression(JsonTrait::parse(
+      JASSTR(R"({"$p":"status/state","@return":{"@field":"$p"}})")));
+  auto start = steady_clock::now();
+  for (int i = 0; i < files; ++i) {
+    auto path = dir / std::to_string(i);
+    Var snapshot;
+    if (mapped) {
+      snapshot = lazySnapshot(SnapshotFile::open(path));
+    } else {
+      std::basic_ifstream<CharType> ifs{path};
+      snapshot = Var(JsonTrait::parse(ifs));
+    }
+    facade.setContext(
+        std::make_shared<HistoricalEvalContext>(nullptr, snapshot));
+    evaluated = facade.evaluate();
+  }
+  auto elapsed =
+      duration<double, std::micro>(steady_clock::now() - start).count() /
+      files;
+  fs::remove_all(dir);
+  return elapsed;
+}
+
+/// Round trip of results of many records through their json text or their
+/// binary encoding
+static double round_trip(bool binary, int iterations, Var& decoded,
+                         size_t& size) {
+  auto data = Var(make_records(20000));
+  auto start = steady_clock::now();
+  for (int i = 0; i < iterations; ++i) {
+    if (binary) {
+      auto encoded = encodeVar(data);
+      size = encoded.size();
+      decoded = decodeVar(encoded);
+    } else {
+      auto text = data.dump();
+      size = text.size() * sizeof(CharType);
+      decoded = Var(JsonTrait::parse(text));
+    }
+  }
+  return duration<double, std::micro>(steady_clock::now() - start).count() /
+         iterations;
+}
+
+int main() {
+  CloggerSection bench{JASSTR("JAS BENCH")};
+  const bench_case cases[] = {
+      {JASSTR("arithmetic"),
+       JASSTR(R"({"$a":3,"$b":4.5,"r":{"@plus":[{"@multiplies":["$a","$b",2]},)"
+              R"({"@minus":["$b",1]},{"@divides":[{"@plus":["$a","$b"]},3]},)"
+              R"({"@negate":{"@minus":["$a",{"@multiplies":["$b","$b"]}]}}]},)"
+              R"("c":{"@and":[{"@lt":["$a","$b"]},{"@or":[{"@eq":["$a",3]},)"
+              R"({"@gt":["$b",10]}]}]}})"),
+       nullptr, 20000},
+      {JASSTR("list_condition"),
+       JASSTR(R"({"@count_if":{"@list":"@field:list","@cond":{"@and":[)"
+              R"({"@gt":["$1",10]},{"@lt":[{"@modulus":["$1",7]},3]}]}}})"),
+       make_list(1000), 200},
+      {JASSTR("list_transform"),
+       JASSTR(R"({"@transform":{"@list":"@field:list","@op":{"x":"$1",)"
+              R"("y":{"@multiplies":["$1",2]},"odd":{"@eq":[{"@modulus":)"
+              R"(["$1",2]},1]}}}})"),
+       make_list(1000), 100},
+      {JASSTR("functions"),
+       JASSTR(R"({"!sq":{"@multiplies":["$1","$1"]},"r":{"@transform":{)"
+              R"("@list":"@field:list","@op":{"$n":{"@sq":["$1"]},"@s_plus":)"
+              R"(["$n",{"@len":["$1","$1"]}]}}}})"),
+       make_list(1000), 100},
+  };
+
+  for (auto& bc : cases) {
+    JASFacade facade;
+    facade.setContext(std::make_shared<HistoricalEvalContext>(nullptr, bc.data));
+    facade.setExpression(JsonTrait::parse(bc.rule));
+    Var interpreted, compiled;
+    auto interpreterTime = run(facade, SyntaxEvaluator::Engine::Interpreter,
+                               bc.iterations, interpreted);
+    auto closuresTime = run(facade, SyntaxEvaluator::Engine::Closures,
+                            bc.iterations, compiled);
+    cloginfo() << bc.name << ": interpreter " << interpreterTime
+               << "us - closures " << closuresTime << "us - speedup "
+               << interpreterTime / closuresTime
+               << (interpreted == compiled ? JASSTR("") : JASSTR(" - MISMATCH"));
+  }
+
+  auto records = make_records(1000);
+  Var generic, native;
+  auto genericTime = predicate(records, false, 100, generic);
+  auto nativeTime = predicate(records, true, 100, native);
+  cloginfo() << "field_predicate: generic " << genericTime << "us - native "
+             << nativeTime << "us - speedup " << genericTime / nativeTime
+             << (generic == native ? JASSTR("") : JASSTR(" - MISMATCH"));
+
+  Var built, fused;
+  auto builtTime = pipeline(false, 20, built);
+  auto fusedTime = pipeline(true, 20, fused);
+  cloginfo() << "pipeline: intermediate lists " << builtTime << "us - fused "
+             << fusedTime << "us - speedup " << builtTime / fusedTime
+             << (built == fused ? JASSTR("") : JASSTR(" - MISMATCH"));
+
+  Var shortCount, longCount;
+  auto shortLoopTime = long_loop(10000, shortCount);
+  auto peakBefore = peak_memory_kb();
+  auto longLoopTime = long_loop(1000000, longCount);
+  cloginfo() << "long_loop: 10000 items " << shortLoopTime
+             << "us/item - 1000000 items " << longLoopTime
+             << "us/item - peak memory grew " << peak_memory_kb() - peakBefore
+             << "KB" << (longCount == Var(999989) ? JASSTR("")
+                                                  : JASSTR(" - MISMATCH"));
+
+  auto unsorted = make_records(5000);
+  Var byPredicate, byKey;
+  auto predicateTime = sort(unsorted, false, 5, byPredicate);
+  auto keyTime = sort(unsorted, true, 5, byKey);
+  cloginfo() << "sort: predicate " << predicateTime << "us - key "
+             << keyTime << "us - speedup " << predicateTime / keyTime;
+
+  Var plusAppended, selfAppended;
+  auto plusAppendTime = append(false, 200000, 10, plusAppended);
+  auto selfAppendTime = append(true, 200000, 10, selfAppended);
+  cloginfo() << "append: plus " << plusAppendTime << "us - s_plus "
+             << selfAppendTime << "us - speedup "
+             << plusAppendTime / selfAppendTime
+             << (selfAppended == plusAppended ? JASSTR("")
+                                              : JASSTR(" - MISMATCH"));
+
+  Var compared, looked;
+  auto comparedTime = changes(false, 20, compared);
+  auto lookedTime = changes(true, 20, looked);
+  cloginfo() << "snapshot_changes: compare " << comparedTime << "us - diff "
+             << lookedTime << "us - speedup " << comparedTime / lookedTime;
+
+  Var evaluatedEach, reused;
+  auto evaluateTime = unchanged(false, 100, evaluatedEach);
+  auto reuseTime = unchanged(true, 100, reused);
+  cloginfo() << "unchanged_inputs: evaluate " << evaluateTime << "us - reuse "
+             << reuseTime << "us - speedup " << evaluateTime / reuseTime
+             << (evaluatedEach == reused ? JASSTR("") : JASSTR(" - MISMATCH"));
+
+  Var parsedWhole, projected;
+  auto wholeTime = ingest(false, 10, parsedWhole);
+  auto projectedTime = ingest(true, 10, projected);
+  cloginfo() << "projected_ingest: whole " << wholeTime << "us - projected "
+             << projectedTime << "us - speedup " << wholeTime / projectedTime
+             << (parsedWhole == projected ? JASSTR("") : JASSTR(" - MISMATCH"));
+
+  Var convertedWhole, viewed;
+  auto convertTime = view(false, 10, convertedWhole);
+  auto viewTime = view(true, 10, viewed);
+  cloginfo() << "json_view: convert " << convertTime << "us - view "
+             << viewTime << "us - speedup " << convertTime / viewTime
+             << (convertedWhole == viewed ? JASSTR("") : JASSTR(" - MISMATCH"));
+
+  Var readWhole, decodedOnDemand;
+  auto readTime = archived(false, 20, readWhole);
+  auto mappedTime = archived(true, 20, decodedOnDemand);
+  cloginfo() << "archived_snapshots: read " << readTime << "us - mapped "
+             << mappedTime << "us - speedup " << readTime / mappedTime
+             << (readWhole == decodedOnDemand ? JASSTR("")
+                                              : JASSTR(" - MISMATCH"));
+
+  Var fromJson, fromBinary;
+  size_t jsonSize, binarySize;
+  auto jsonTime = round_trip(false, 10, fromJson, jsonSize);
+  auto binaryTime = round_trip(true, 10, fromBinary, binarySize);
+  cloginfo() << "binary_codec: json " << jsonTime << "us - binary "
+             << binaryTime << "us - speedup " << jsonTime / binaryTime
+             << " - size " << jsonSize << "/" << binarySize
+             << (fromJson.dump() == fromBinary.dump() ? JASSTR("")
+                                                      : JASSTR(" - MISMATCH"));
+
+  size_t rewrittenSize, appendedSize;
+  auto rewriteTime = persist(false, 50, rewrittenSize);
+  auto appendTime = persist(true, 50, appendedSize);
+  cloginfo() << "persist_results: rewrite " << rewriteTime << "us - append "
+             << appendTime << "us - speedup " << rewriteTime / appendTime
+             << " - written " << rewrittenSize << "/" << appendedSize;
+
+  size_t heldNodes, wholeNodes;
+  auto pushTime = history(50, heldNodes, wholeNodes);
+  cloginfo() << "snapshot_history: convert and push " << pushTime
+             << "us - values held " << heldNodes << " of " << wholeNodes;
+
+  JASFacade facade;
+  auto bigRule = make_big_rule(2000);
+  auto heapTime = translate(facade, bigRule, false, 20);
+  auto arenaTime = translate(facade, bigRule, true, 20);
+  cloginfo() << "translate_release: heap " << heapTime << "us - arena "
+             << arenaTime << "us - speedup " << heapTime / arenaTime;
+  return 0;
+}
@@ -1,13 +1,25 @@
 
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <sstream>
+#include <thread>
 
 #include "jas/ConsoleLogger.h"
+#include "jas/EvaluableClasses.h"
 #include "jas/HistoricalEvalContext.h"
 #include "jas/JASFacade.h"
 #include "jas/Json.h"
+#include "jas/SnapshotParser.h"
+#include "jas/SyntaxEvaluator.h"
 #include "jas/Translator.h"
+#include "jas/VarCodec.h"
+
+#if defined(__unix__) && !defined(__SANITIZE_ADDRESS__)
+#define JAS_TEST_PEAK_MEMORY 1
+#include <sys/resource.h>
+#endif
 
 namespace jas {
 namespace fs = std::filesystem;
@@ -25,25 +37,96 @@ __mc_jas_exception(data_error);
 
 static JASFacade& jas_facade();
 static int run_all_tests(const fs::path& testcase_dir);
+static void run_all_tests_in(const fs::path& testcase_dir);
+static void check_long_loop_memory();
+static void check_cached_hashes();
+static void check_unbindable_contexts();
+static void check_reused_results();
+static void check_shared_views();
+static void check_deferred_variables();
+static void check_arena_nodes();
+static void check_specialized_operators();
+static void check_closure_contexts();
+static void check(bool passed, const CharType* name);
+static void set_optimized(bool on);
+static void set_engine(SyntaxEvaluator::Engine engine);
 static test_cases load_no_input_test_cases(const fs::path& data_file);
 static test_cases load_has_input_test_cases(const fs::path& data_file);
 static void run_test_case(const test_case& tc);
+static Var evaluate_test_case(const test_case& tc);
 static void failed_test_case(const test_case& tc, const String& syntax,
                              const Var& observed, const String& reason = {});
 static void success_test_case(const test_case& tc);
 static Json parse_test_case(const String& data);
-static EvalContextPtr make_eval_ctxt(Json data);
+static EvalContextPtr make_eval_ctxt(Json data, const Json& rule);
 
 static int total_passes = 0;
 static int total_failed = 0;
+static bool optimized = false;
+static bool compiled = false;
+static bool viewed = false;
 
 JASFacade& jas_facade() {
   static JASFacade _;
   return _;
 }
 
+static void set_optimized(bool on) {
+  Translator::Optimizations opts;
+  opts.eliminateCommonSubexpressions = on;
+  opts.lazyLocalVariables = on;
+  opts.inlineMacros = on;
+  opts.inferTypes = on;
+  opts.fieldPredicates = on;
+  opts.fuseListPipelines = on;
+  opts.arenaAllocation = on;
+  opts.reuseUnchangedResults = on;
+  opts.projectSnapshots = on;
+  jas_facade().getParser()->setOptimizations(opts);
+  optimized = on;
+}
+
+static void set_engine(SyntaxEvaluator::Engine engine) {
+  jas_facade().getEvaluator()->setEngine(engine);
+  compiled = engine == SyntaxEvaluator::Engine::Closures;
+}
+
 static int run_all_tests(const fs::path& testcase_dir) {
   CLoggerTimerSection allTestSection(JASSTR("All test"));
+  check_cached_hashes();
+  check_reused_results();
+  check_shared_views();
+  check_deferred_variables();
+  check_arena_nodes();
+  check_specialized_operators();
+  check_closure_contexts();
+  // every test case runs as is and with translate-time optimizations, on both
+  // the interpreter and the compiled closures. Unoptimized, inputs are
+  // converted from json as well as viewed
+  for (auto engine : {SyntaxEvaluator::Engine::Interpreter,
+                      SyntaxEvaluator::Engine::Closures}) {
+    set_engine(engine);
+    for (auto on : {false, true}) {
+      set_optimized(on);
+      check_long_loop_memory();
+      check_unbindable_contexts();
+      for (auto view : {false, true}) {
+        if (view && on) {
+          continue;
+        }
+        viewed = view;
+        run_all_tests_in(testcase_dir);
+      }
+    }
+  }
+  viewed = false;
+  cloginfo() << "\nSUMARY:"
+             << "\nTotal passes: " << total_passes
+             << "\nTotal failed: " << total_failed;
+  return total_failed;
+}
+
+static void run_all_tests_in(const fs::path& testcase_dir) {
   std::error_code ec;
   for (auto it = fs::directory_iterator{testcase_dir, ec};
        it != fs::directory_iterator{}; ++it) {
@@ -73,10 +156,273 @@ static int run_all_tests(const fs::path& testcase_dir) {
       }
     }
   }
-  cloginfo() << "\nSUMARY:"
-             << "\nTotal passes: " << total_passes
-             << "\nTotal failed: " << total_failed;
-  return total_failed;
+}
+
+/// Operands of operators evaluated for each item of a long list must be
+/// reused: the peak memory of such a loop is checked against the one of the
+/// same loop on a constant condition
+static void check_long_loop_memory() {
+#ifdef JAS_TEST_PEAK_MEMORY
+  auto peak_kb = [] {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+  };
+  auto loop = [](const CharType* cond) {
+    jas_facade().evaluate(
+        JsonTrait::parse(strJoin(
+            JASSTR(R"({"@count_if":{"@list":{"@range":[0,200000]},"@cond":)"),
+            cond, JASSTR("}}"))),
+        std::make_shared<HistoricalEvalContext>());
+  };
+  loop(JASSTR("true"));
+  auto constant_peak = peak_kb();
+  loop(JASSTR(R"({"@and":[{"@gt":["$1",10]},{"@lt":["$1",200000]}]})"));
+  check(peak_kb() - constant_peak <= 16 * 1024, JASSTR("LONG LOOP MEMORY"));
+#endif
+}
+
+/// Hashes cached on values converted from json must not outlive changes of
+/// their children, modified in place or through other holders
+static void check_cached_hashes() {
+  auto json = [](const CharType* text) { return Var(JsonTrait::parse(text)); };
+  auto expected = json(JASSTR(R"({"k":[1,1],"n":2})"));
+  auto held = json(JASSTR(R"({"k":[1],"n":2})"));
+  auto& k = held[JASSTR("k")];
+  held.hash();
+  k.add(1);
+  check(held == expected && held.hash() == expected.hash(),
+        JASSTR("HASH OF A CHILD HELD FOR MODIFICATION"));
+  auto shared = json(JASSTR(R"({"k":[1],"n":2})"));
+  auto child = shared.getAt(JASSTR("k"));
+  shared.hash();
+  child.add(1);
+  check(shared == expected && shared.hash() == expected.hash(),
+        JASSTR("HASH OF A SHARED CHILD"));
+  auto scalar = json(JASSTR(R"({"k":[1,1],"n":1})"));
+  auto n = scalar.getAt(JASSTR("n"));
+  scalar.hash();
+  n.asNumber() = Number{2};
+  check(scalar == expected && scalar.hash() == expected.hash(),
+        JASSTR("HASH OF A SHARED SCALAR"));
+}
+
+/// Context of a subclass creating sub contexts of its own, which cannot be
+/// rebound from one list item to the next
+class SubclassedContext : public BasicEvalContext {
+ public:
+  using BasicEvalContext::BasicEvalContext;
+  EvalContextPtr subContext(const String& ctxtID,
+                            ContextArguments input) override {
+    return std::make_shared<SubclassedContext>(this, ctxtID, std::move(input));
+  }
+};
+
+/// List items are evaluated on contexts of their own when item contexts
+/// cannot be rebound
+static void check_unbindable_contexts() {
+  Var evaluated;
+  try {
+    evaluated = jas_facade().evaluate(
+        JsonTrait::parse(JASSTR(
+            R"({"@transform":{"@list":[1,2,3],"@cond":{"@plus":["$1",10]}}})")),
+        std::make_shared<SubclassedContext>());
+  } catch (const Exception& e) {
+    cloginfo() << e.what();
+  }
+  check(evaluated == Var(JsonTrait::parse(JASSTR("[11,12,13]"))),
+        JASSTR("ITEMS ON UNBINDABLE CONTEXTS"));
+}
+
+/// A stored result is reused for the rule that stored it only, and each
+/// context keeps the one of the rule last evaluated on it. What is kept to
+/// compare is of a fixed size, whatever the rule reads, and rules cannot
+/// read it
+static void check_reused_results() {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.reuseUnchangedResults = true;
+  facade.getParser()->setOptimizations(opts);
+  auto stored = std::make_shared<HistoricalEvalContext::EvaluatedVariables>();
+  auto evaluate = [&](const CharType* rule, Var snapshot) {
+    auto context =
+        std::make_shared<HistoricalEvalContext>(nullptr, std::move(snapshot));
+    context->setLastEvalResult(stored);
+    facade.setContext(context);
+    facade.setExpression(JsonTrait::parse(rule));
+    return facade.evaluate();
+  };
+  auto small = Var(JsonTrait::parse(JASSTR(R"({"a":1})")));
+  auto plusOne = JASSTR(R"({"@plus":["@field_cv:a",1]})");
+  auto first = evaluate(plusOne, small);
+  auto other = evaluate(JASSTR(R"({"@plus":["@field_cv:a",2]})"), small);
+  auto again = evaluate(plusOne, small);
+  check(first == Var(2) && other == Var(3) && again == Var(2) &&
+            stored->toVar().size() == 1,
+        JASSTR("RESULTS REUSED BY RULE"));
+
+  auto large = Var::list();
+  for (int i = 0; i < 2000; ++i) {
+    large.add(Var(static_cast<Var::Int>(i)));
+  }
+  auto length =
+      evaluate(JASSTR(R"({"@list.len":"@field_cv:list"})"),
+               Var::dict({{JASSTR("list"), large}}));
+  auto reader = std::make_shared<HistoricalEvalContext>(nullptr, small);
+  reader->setLastEvalResult(stored);
+  auto record = reader->invoke(JASSTR("last_eval"), Var(JASSTR("@result")));
+  check(length == Var(2000) && record.isNull() &&
+            encodeVar(stored->toVar()).size() < 128,
+        JASSTR("REUSED RESULTS STORED BY DIGEST"));
+}
+
+/// Variables never read are not evaluated when deferred, eager declarations
+/// of the same rule fail
+static void check_deferred_variables() {
+  auto rule = JsonTrait::parse(
+      JASSTR(R"({"$bad":{"@plus":[1,true]},"@or":[true,"$bad"]})"));
+  auto evaluate = [&rule](bool deferred) {
+    JASFacade facade;
+    Translator::Optimizations opts;
+    opts.lazyLocalVariables = deferred;
+    facade.getParser()->setOptimizations(opts);
+    try {
+      return facade.evaluate(rule, std::make_shared<BasicEvalContext>());
+    } catch (const Exception& e) {
+      return Var(e.details);
+    }
+  };
+  auto eager = evaluate(false);
+  check(evaluate(true) == Var(true) && eager.isString() &&
+            eager.asString().find(JASSTR("EvaluationError")) != String::npos,
+        JASSTR("UNREAD VARIABLES DEFERRED"));
+}
+
+/// Nodes of a tree allocated from an arena keep it alive after their root
+/// is released
+static void check_arena_nodes() {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.arenaAllocation = true;
+  facade.getParser()->setOptimizations(opts);
+  auto root = facade.getParser()->translate(
+      std::make_shared<BasicEvalContext>(),
+      Var(JsonTrait::parse(JASSTR(R"({"@plus":[{"@minus":[5,2]},1]})"))));
+  auto plus = std::dynamic_pointer_cast<ArithmaticalOperator>(root);
+  EvaluablePtr kept;
+  if (plus && !plus->params.empty()) {
+    kept = plus->params.front();
+  }
+  plus.reset();
+  root.reset();
+  check(kept && SyntaxEvaluator{}.evaluate(kept) == Var(3),
+        JASSTR("ARENA NODES KEPT AFTER THEIR ROOT"));
+}
+
+/// Operators of proven operand types are specialized and marked with the type
+/// in translated syntax. Variables of macros are resolved where the macros
+/// are invoked, operators of macros are not specialized
+static void check_specialized_operators() {
+  JASFacade facade;
+  Translator::Optimizations opts;
+  opts.inferTypes = true;
+  facade.getParser()->setOptimizations(opts);
+  Var evaluated;
+  try {
+    evaluated = facade.evaluate(
+        JsonTrait::parse(JASSTR(
+            R"({"$n":2,"!twice":{"@plus":["$n","$n"]},"a":{"@multiplies":["$n",3]},"b":{"$n":"x","@return":"@twice"}})")),
+        std::make_shared<BasicEvalContext>());
+  } catch (const Exception& e) {
+    evaluated = e.details;
+  }
+  auto syntax = facade.getTransformedSyntax();
+  check(evaluated == Var(JsonTrait::parse(JASSTR(R"({"a":6,"b":"xx"})"))) &&
+            facade.getParser()->lastReport().specializedOperators == 1 &&
+            syntax.find(JASSTR("*<number>")) != String::npos &&
+            syntax.find(JASSTR("+<")) == String::npos,
+        JASSTR("SPECIALIZED OPERATORS"));
+}
+
+/// Context of which `path` function returns ids of the contexts it is invoked
+/// through, pure or not as told by `_pure`
+template <bool _pure>
+class PathContext : public BasicEvalContext {
+ public:
+  PathContext(String path = {}) : path_(std::move(path)) {}
+  bool functionSupported(const StringView& name) const override {
+    return name == JASSTR("path");
+  }
+  bool functionIsPure(const StringView&) const override { return _pure; }
+  Var invoke(const String&, const Var&) override { return path_; }
+  EvalContextPtr subContext(const String& ctxtID,
+                            ContextArguments input) override {
+    auto sub = std::make_shared<PathContext>(strJoin(path_, '/', ctxtID));
+    sub->args(std::move(input));
+    return sub;
+  }
+
+ private:
+  String path_;
+};
+
+/// Closures compiled for a root context are not reused for a context of
+/// another type, on which frames elided for pure functions are observable
+static void check_closure_contexts() {
+  JASFacade facade;
+  auto evaluator = facade.getEvaluator();
+  Var pure, compiled, interpreted;
+  try {
+    evaluator->setEngine(SyntaxEvaluator::Engine::Closures);
+    facade.setContext(std::make_shared<PathContext<true>>());
+    facade.setExpression(
+        JsonTrait::parse(JASSTR(R"({"a":{"@plus":[{"@path":""},"!"]}})")));
+    pure = facade.evaluate();
+    facade.setContext(std::make_shared<PathContext<false>>());
+    compiled = facade.evaluate();
+    evaluator->setEngine(SyntaxEvaluator::Engine::Interpreter);
+    interpreted = facade.evaluate();
+  } catch (const Exception& e) {
+    cloginfo() << e.what();
+  }
+  check(!interpreted.isNull() && compiled == interpreted && pure != compiled,
+        JASSTR("CLOSURES COMPILED PER CONTEXT TYPE"));
+}
+
+/// Views shared across threads are converted once for all of their readers
+static void check_shared_views() {
+  auto json = std::make_shared<const Json>(JsonTrait::parse(JASSTR(
+      R"({"a":[{"b":1,"c":[1,2]},{"b":2,"c":[3]}],"d":{"e":"f"}})")));
+  auto expected = Var(*json);
+  for (int round = 0; round < 20; ++round) {
+    auto viewed = Var::view(json);
+    std::vector<int> matched(8);
+    std::vector<std::thread> readers;
+    for (auto& m : matched) {
+      readers.emplace_back([&viewed, &expected, &m] {
+        m = viewed.getPath(JASSTR("a/1/c/0")) == Var(3) &&
+            viewed.hash() == expected.hash() && viewed == expected;
+      });
+    }
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    if (std::count(std::begin(matched), std::end(matched), 1) != 8) {
+      check(false, JASSTR("VIEWS SHARED ACROSS THREADS"));
+      return;
+    }
+  }
+  check(true, JASSTR("VIEWS SHARED ACROSS THREADS"));
+}
+
+/// Checks of behaviors out of reach of test cases, counted with them
+static void check(bool passed, const CharType* name) {
+  if (passed) {
+    ++total_passes;
+  } else {
+    ++total_failed;
+    cloginfo() << JASSTR("[") << name << JASSTR("][FAILED]\n");
+  }
 }
 
 static test_cases load_no_input_test_cases(const fs::path& data_file) {
@@ -135,9 +481,13 @@ static test_cases load_has_input_test_cases(const fs::path& data_file) {
 }
 static void run_test_case(const test_case& tc) {
   try {
-    auto evaluated =
-        jas_facade().evaluate(tc.rule, make_eval_ctxt(tc.context_data));
-    if (JsonTrait::equal(tc.expected, evaluated.toJson())) {
+    auto evaluated = evaluate_test_case(tc);
+    // results must also come back the same from their binary encoding
+    if (auto decoded = decodeVar(encodeVar(evaluated));
+        decoded.dump() != evaluated.dump()) {
+      failed_test_case(tc, JsonTrait::dump(tc.rule), {},
+                       JASSTR("binary encoding decoded to ") + decoded.dump());
+    } else if (JsonTrait::equal(tc.expected, evaluated.toJson())) {
       success_test_case(tc);
     } else {
       failed_test_case(tc, jas_facade().getTransformedSyntax(), evaluated);
@@ -155,10 +505,45 @@ static void run_test_case(const test_case& tc) {
   }
 }
 
+/// Inputs of a sequence are evaluated one after the other with the same
+/// stored results, saved and loaded again in binary if optimized. Their
+/// results are listed
+static Var evaluate_test_case(const test_case& tc) {
+  if (!JsonTrait::isObject(tc.context_data) ||
+      !JsonTrait::hasKey(tc.context_data, JASSTR("__sequence"))) {
+    return jas_facade().evaluate(tc.rule,
+                                 make_eval_ctxt(tc.context_data, tc.rule));
+  }
+  auto inputs = Var(JsonTrait::get(tc.context_data, JASSTR("__sequence")));
+  auto stored = std::make_shared<HistoricalEvalContext::EvaluatedVariables>();
+  auto results = Var::list();
+  std::string saved;
+  for (auto& input : inputs.asList()) {
+    auto context = make_eval_ctxt(input.toJson(), tc.rule);
+    auto& historical = static_cast<HistoricalEvalContext&>(*context);
+    if (saved.empty()) {
+      historical.setLastEvalResult(stored);
+    } else {
+      std::istringstream iss{saved};
+      historical.loadEvaluationResultBinary(iss);
+    }
+    results.add(jas_facade().evaluate(tc.rule, context));
+    if (optimized) {
+      std::ostringstream oss;
+      historical.saveEvaluationResultBinary(oss);
+      saved = oss.str();
+    }
+  }
+  return results;
+}
+
 static void failed_test_case(const test_case& tc, const String& syntax,
                              const Var& observed, const String& reason) {
   ++total_failed;
   cloginfo() << JASSTR("TC[") << tc.data_line_number
+             << (optimized ? JASSTR("][OPTIMIZED") : JASSTR(""))
+             << (compiled ? JASSTR("][CLOSURES") : JASSTR(""))
+             << (viewed ? JASSTR("][VIEWS") : JASSTR(""))
              << JASSTR("][FAILED] - syntax: ") << syntax;
   if (!observed.isNull()) {
     cloginfo() << JASSTR(" - [expected]: ") << JsonTrait::dump(tc.expected)
@@ -175,14 +560,56 @@ static Json parse_test_case(const String& data) {
   return JsonTrait::parse(data);
 }
 
-static EvalContextPtr make_eval_ctxt(Json data) {
-  if (JsonTrait::isObject(data) && JsonTrait::hasKey(data, JASSTR("__old")) &&
-      JsonTrait::hasKey(data, JASSTR("__new"))) {
+/// Snapshots are converted from the json inputs, or are views of them, or,
+/// optimized, parsed again from their json texts at the paths that the rule
+/// reads only, or decoded on demand if those are not known
+static EvalContextPtr make_eval_ctxt(Json data, const Json& rule) {
+  // snapshots of a history are given the oldest first
+  if (JsonTrait::isObject(data) &&
+      JsonTrait::hasKey(data, JASSTR("__history"))) {
+    auto snapshots = Var(JsonTrait::get(data, JASSTR("__history")));
+    auto history = std::make_shared<SnapshotHistory>(snapshots.size());
+    for (auto& snapshot : snapshots.asList()) {
+      history->push(snapshot);
+    }
+    return std::make_shared<HistoricalEvalContext>(nullptr, std::move(history));
+  }
+  auto hasOldAndNew = JsonTrait::isObject(data) &&
+                     JsonTrait::hasKey(data, JASSTR("__old")) &&
+                     JsonTrait::hasKey(data, JASSTR("__new"));
+  if (!optimized && !viewed) {
+    if (hasOldAndNew) {
+      return std::make_shared<HistoricalEvalContext>(
+          nullptr, JsonTrait::get(data, JASSTR("__new")),
+          JsonTrait::get(data, JASSTR("__old")));
+    } else {
+      return std::make_shared<HistoricalEvalContext>(nullptr, std::move(data));
+    }
+  }
+  std::shared_ptr<const SnapshotReads> reads;
+  if (optimized) {
+    auto parser = jas_facade().getParser();
+    parser->translate(std::make_shared<HistoricalEvalContext>(), rule);
+    reads = parser->snapshotReads();
+  }
+  auto snapshot = [&](const Json& json, bool current) {
+    if (!optimized) {
+      return Var::view(std::make_shared<const Json>(json));
+    }
+    auto text = std::make_shared<const String>(JsonTrait::dump(json));
+    if (!reads) {
+      return lazySnapshot(*text, text);
+    }
+    return parseSnapshot(*text, SnapshotProjection{current ? reads->current
+                                                           : reads->last});
+  };
+  if (hasOldAndNew) {
     return std::make_shared<HistoricalEvalContext>(
-        nullptr, JsonTrait::get(data, JASSTR("__new")),
-        JsonTrait::get(data, JASSTR("__old")));
+        nullptr, snapshot(JsonTrait::get(data, JASSTR("__new")), true),
+        snapshot(JsonTrait::get(data, JASSTR("__old")), false));
   } else {
-    return std::make_shared<HistoricalEvalContext>(nullptr, std::move(data));
+    return std::make_shared<HistoricalEvalContext>(nullptr,
+                                                   snapshot(data, true));
   }
 }
 
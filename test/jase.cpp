@@ -8,6 +8,7 @@
 #include "jas/Json.h"
 #include "jas/Keywords.h"
 #include "jas/ModuleManager.h"
+#include "jas/SnapshotParser.h"
 #include "jas/Translator.h"
 #include "jas/Version.h"
 
@@ -28,11 +29,13 @@ void showHelp(int exitCode = -1) {
       R"(JASE - JAS Evaluator: Parse jas.dat file that contains jas syntax and data for evaluation and show the
 evaluated result!
 
-Usage1: jase.exe /path/to/jas.dat
+Usage1: jase.exe /path/to/jas.dat [--binary]
     structure of jas.dat:
       - line1: jas syntax (json)
       - [line2]: (optional) current input data (json), historically - current snapshot
       - [line3]: (optional) last input data (json), historically - last snapshot
+    - binary: evaluation results are loaded from and saved to jas.hbin in MessagePack
+      instead of the jas.hlog json log
 
 Usage2: jase.exe [--help|--keywords|--version]
     - help: show help instruction and exit
@@ -121,6 +124,17 @@ void checkInfoQueryInfoOption(const String& argv1) {
 using Ifstream = basic_ifstream<CharType>;
 using Ofstream = basic_ofstream<CharType>;
 
+/// Up to `count` first lines of `text`
+static vector<StringView> firstLines(StringView text, size_t count) {
+  vector<StringView> lines;
+  while (!text.empty() && lines.size() < count) {
+    auto end = text.find(JASSTR('\n'));
+    lines.push_back(text.substr(0, end));
+    text = end == StringView::npos ? StringView{} : text.substr(end + 1);
+  }
+  return lines;
+}
+
 int main(int argc, char** argv) {
   if (argc < 2) {
     showHelp();
@@ -134,52 +148,79 @@ int main(int argc, char** argv) {
   CLoggerTimerSection showTitleSct{JASE_TITLE};
   std::error_code ec;
   auto jasFile = fs::path{oss.str()};
+  auto binaryResult = argc > 2 && argv[2] == std::string_view{"--binary"};
   exitIf(!fs::exists(jasFile, ec), "Input file doens't exist!");
 
-  Ifstream ifs(jasFile);
-  exitIf(!ifs.is_open(), "Cannot open file ", jasFile);
-  String strExpression, strCurrentInput, strLastInput;
+  // snapshots are read from the mapped file as they are decoded
+  auto jasText = SnapshotFile::open(jasFile);
+  exitIf(!jasText, "Cannot open file ", jasFile);
+  auto lines = firstLines(jasText->text(), 3);
 
-  exitIf(!getline(ifs, strExpression), "Failed to read jas expression");
-  auto jexpression = JsonTrait::parse(strExpression);
-  if (getline(ifs, strCurrentInput)) {
-    if (!getline(ifs, strLastInput)) {
-      cloginfo() << "No last input data";
-    }
-  } else {
+  exitIf(lines.empty(), "Failed to read jas expression");
+  auto jexpression = JsonTrait::parse(String{lines[0]});
+  if (lines.size() == 2) {
+    cloginfo() << "No last input data";
+  } else if (lines.size() == 1) {
     cloginfo() << "No input data";
   }
-
-  auto jcurrentInput = JsonTrait::parse(strCurrentInput);
-  auto jLastInput = JsonTrait::parse(strLastInput);
+  lines.resize(3);
 
   try {
-    auto historicalContext =
-        make_shared<HistoricalEvalContext>(nullptr, jcurrentInput, jLastInput);
-
-    auto lastEvalResultFile = jasFile;
-    lastEvalResultFile.replace_extension(".his");
-    auto debugLogFile = jasFile;
-    debugLogFile.replace_extension(".debug");
-
-    HistoricalEvalContext::EvaluatedVariablesPtr lastEvalResult;
-    if (fs::exists(lastEvalResultFile, ec)) {
-      cloginfo() << "Load evaluation result from " << lastEvalResultFile;
-      Ifstream lerifs{lastEvalResultFile};
-      historicalContext->loadEvaluationResult(lerifs);
-    }
     {
-      jasFacade().setContext(historicalContext);
+      // the rule is translated first, for the inputs to be parsed at the
+      // snapshot paths it reads only, or decoded on demand if those are not
+      // known
+      Translator::Optimizations opts;
+      opts.projectSnapshots = true;
+      jasFacade().getParser()->setOptimizations(opts);
+      auto ruleContext = make_shared<HistoricalEvalContext>();
+      jasFacade().setContext(ruleContext);
       cloginfo() << "JAS reconstructed: "
                  << jasFacade()
                         .getParser()
-                        ->reconstructJAS(historicalContext, jexpression)
+                        ->reconstructJAS(ruleContext, jexpression)
                         .toJson();
       jasFacade().setExpression(jexpression);
 
       CloggerSection transformSyntaxSct(JASSTR("Transformed syntax"));
       cloginfo() << jasFacade().getTransformedSyntax();
     }
+    auto reads = jasFacade().getParser()->snapshotReads();
+    auto snapshot = [&jasText, &reads](StringView line, bool current) {
+      if (!reads) {
+        return lazySnapshot(line, jasText);
+      }
+      return parseSnapshot(line, SnapshotProjection{current ? reads->current
+                                                            : reads->last});
+    };
+    auto historicalContext = make_shared<HistoricalEvalContext>(
+        nullptr, snapshot(lines[1], true), snapshot(lines[2], false));
+
+    auto lastEvalResultFile = jasFile;
+    lastEvalResultFile.replace_extension(".his");
+    auto evalResultLogFile = jasFile;
+    evalResultLogFile.replace_extension(".hlog");
+    auto binaryResultFile = jasFile;
+    binaryResultFile.replace_extension(".hbin");
+    auto debugLogFile = jasFile;
+    debugLogFile.replace_extension(".debug");
+
+    if (binaryResult) {
+      if (fs::exists(binaryResultFile, ec)) {
+        cloginfo() << "Load evaluation result from " << binaryResultFile;
+        std::ifstream lerifs{binaryResultFile, ios_base::binary};
+        historicalContext->loadEvaluationResultBinary(lerifs);
+      }
+    } else if (fs::exists(evalResultLogFile, ec)) {
+      cloginfo() << "Load evaluation result log from " << evalResultLogFile;
+      Ifstream lerifs{evalResultLogFile};
+      historicalContext->setLastEvalResult(EvalResultStore::fromLog(lerifs));
+    } else if (fs::exists(lastEvalResultFile, ec)) {
+      cloginfo() << "Load evaluation result from " << lastEvalResultFile;
+      Ifstream lerifs{lastEvalResultFile};
+      historicalContext->loadEvaluationResult(lerifs);
+    }
+    jasFacade().setContext(historicalContext);
     try {
       CLoggerTimerSection evalResultSct(JASSTR("Evaluation result"));
       Ofstream debugLogFileStream{debugLogFile};
@@ -192,9 +233,31 @@ int main(int argc, char** argv) {
       clogerr() << "ERROR: " << e.what();
     }
 
-    Ofstream lastResultFileStream{lastEvalResultFile};
-    if (historicalContext->saveEvaluationResult(lastResultFileStream)) {
-      cloginfo() << "Result saved to " << lastEvalResultFile;
+    if (binaryResult) {
+      std::ofstream resultStream{binaryResultFile, ios_base::binary};
+      if (historicalContext->saveEvaluationResultBinary(resultStream)) {
+        cloginfo() << "Result saved to " << binaryResultFile;
+      }
+      return 0;
+    }
+    historicalContext->syncEvalResult();
+    auto& evalResult = *historicalContext->lastEvalResult();
+    if (evalResult.compactionDue() || !fs::exists(evalResultLogFile, ec)) {
+      // replaces the log only once the compacted one is completely written
+      auto compactedLogFile = evalResultLogFile;
+      compactedLogFile += ".tmp";
+      Ofstream compactedLogStream{compactedLogFile};
+      auto written = evalResult.writeLog(compactedLogStream);
+      compactedLogStream.close();
+      if (written && compactedLogStream) {
+        fs::rename(compactedLogFile, evalResultLogFile, ec);
+        cloginfo() << "Result log compacted to " << evalResultLogFile;
+      }
+    } else {
+      Ofstream logStream{evalResultLogFile, ios_base::app};
+      if (evalResult.appendLog(logStream)) {
+        cloginfo() << "Result appended to " << evalResultLogFile;
+      }
     }
   } catch (const Exception& e) {
     clogerr() << "ERROR: " << e.what();